@@ -0,0 +1,45 @@
+/*!
+    \file       cgcs_malloc_bench.h
+    \brief      Helpers shared by the cgcs_malloc benchmarks;
+                include it before any other header
+
+    \author     Gemuele Aludino
+    \date       18 Oct 2026
+ */
+
+#ifndef CGCS_MALLOC_BENCH_H
+#define CGCS_MALLOC_BENCH_H
+
+// `clock_gettime`, `CLOCK_MONOTONIC` and `wait4` are hidden by strict ISO C (`-std=c11`).
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include <stdint.h>
+#include <time.h>
+
+/*!
+    \brief      Advances a xorshift32 state and returns its next value.
+
+    \param[in]  state   Generator state, non-zero
+
+    \return     next pseudo-random value
+ */
+static inline uint32_t bench_random(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/*!
+    \brief      Returns a monotonic timestamp, in nanoseconds.
+ */
+static inline uint64_t bench_now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)(ts.tv_sec) * 1000000000ULL + (uint64_t)(ts.tv_nsec);
+}
+
+#endif /* CGCS_MALLOC_BENCH_H */
@@ -0,0 +1,353 @@
+/*!
+    \file       cgcs_malloc_bench_latency.c
+    \brief      Benchmark for cgcs_malloc: per-operation latency distribution
+
+    \details
+    The main thread times every `cgcs_malloc`/`cgcs_free` it makes
+    on a mixed size distribution, while background threads churn the heap.
+    Percentiles (p50 through p99.99, and the maximum) are reported for each
+    kind of operation, along with the worst operations and what they hit:
+
+    - `tcache`      served by the per-thread cache, no call into the allocator
+    - `search`      `cgcs_malloc_impl` -- first-fit search (and any lock wait)
+    - `coalesce`    `cgcs_free_impl` -- merge and `header_coalesce` (and any lock wait)
+    - `page fault`  the operation took a minor or major page fault
+
+    Usage: cgcs_malloc_bench_latency [operations] [churn threads]
+
+    \author     Gemuele Aludino
+    \date       18 Oct 2026
+ */
+
+#include "cgcs_malloc_bench.h"
+#include "cgcs_malloc.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <pthread.h>
+#include <sys/resource.h>
+
+#define BENCH_DEFAULT_OPERATIONS    200000
+#define BENCH_DEFAULT_CHURN_THREADS 2
+#define BENCH_MAX_CHURN_THREADS     64
+
+#define BENCH_MAIN_SLOTS            16  //!< live allocations held by the timed thread
+#define BENCH_CHURN_SLOTS           8   //!< live allocations held by each churn thread
+#define BENCH_WORST_COUNT           10  //!< slowest operations listed individually
+
+#ifdef RUSAGE_THREAD
+#define BENCH_RUSAGE_WHO RUSAGE_THREAD
+#else
+#define BENCH_RUSAGE_WHO RUSAGE_SELF
+#endif /* RUSAGE_THREAD */
+
+/*!
+    \enum       bench_path
+    \brief      What an operation went through; used to attribute latency
+ */
+enum bench_path {
+    BENCH_PATH_TCACHE,
+    BENCH_PATH_SEARCH,
+    BENCH_PATH_COALESCE,
+    BENCH_PATH_PAGE_FAULT,
+    BENCH_PATH_COUNT
+};
+
+static const char *bench_path_names[BENCH_PATH_COUNT] = {
+    "tcache", "search", "coalesce", "page fault"
+};
+
+/*!
+    \struct     bench_sample
+    \brief      One timed operation
+ */
+typedef struct bench_sample {
+    uint64_t m_ns;
+    uint32_t m_size;
+    uint8_t m_is_free;
+    uint8_t m_path;
+} bench_sample_t;
+
+static atomic_bool churn_running = true;
+
+/*!
+    \brief      Draws a request size from a mix skewed toward small objects:
+                80% within [1, 64], 17% within [65, 256], 3% within [257, 512].
+
+    \param[in]  state   Generator state
+
+    \return     request size, in bytes
+ */
+static size_t bench_random_size(uint32_t *state) {
+    uint32_t pick = bench_random(state) % 100;
+    uint32_t r = bench_random(state);
+
+    if (pick < 80) {
+        return 1 + r % 64;
+    } else if (pick < 97) {
+        return 65 + r % 192;
+    } else {
+        return 257 + r % 256;
+    }
+}
+
+/*!
+    \brief      Returns the number of blocks held by the calling thread's cache.
+ */
+static inline size_t bench_tcache_count() {
+    size_t count = 0;
+
+    for (size_t i = 0; i < CGCS_TCACHE_CLASS_COUNT; ++i) {
+        count += cgcs_tcache.m_count[i];
+    }
+
+    return count;
+}
+
+/*!
+    \brief      Returns the page faults taken so far, as counted by `getrusage`.
+ */
+static inline long bench_page_faults() {
+    struct rusage usage;
+    getrusage(BENCH_RUSAGE_WHO, &usage);
+    return usage.ru_minflt + usage.ru_majflt;
+}
+
+/*!
+    \brief      Background thread: allocates and frees random sizes
+                until `churn_running` is cleared.
+
+    \param[in]  arg     seed for this thread, as `(uintptr_t)`
+
+    \return     `NULL`
+ */
+static void *bench_churn(void *arg) {
+    uint32_t state = (uint32_t)((uintptr_t)(arg));
+    void *slots[BENCH_CHURN_SLOTS] = { NULL };
+
+    while (atomic_load_explicit(&churn_running, memory_order_relaxed)) {
+        size_t i = bench_random(&state) % BENCH_CHURN_SLOTS;
+
+        if (slots[i]) {
+            cgcs_free(slots[i]);
+            slots[i] = NULL;
+        } else if ((slots[i] = cgcs_malloc(1 + bench_random(&state) % 128))) {
+            memset(slots[i], 0xa5, 1);
+        }
+    }
+
+    for (size_t i = 0; i < BENCH_CHURN_SLOTS; ++i) {
+        if (slots[i]) {
+            cgcs_free(slots[i]);
+        }
+    }
+
+    cgcs_tcache_flush();
+    return NULL;
+}
+
+/*!
+    \brief      `qsort` comparator for `uint64_t`, ascending.
+ */
+static int bench_compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)(a);
+    uint64_t y = *(const uint64_t *)(b);
+    return (x > y) - (x < y);
+}
+
+/*!
+    \brief      `qsort` comparator for `bench_sample_t`, slowest first.
+ */
+static int bench_compare_sample_desc(const void *a, const void *b) {
+    uint64_t x = ((const bench_sample_t *)(a))->m_ns;
+    uint64_t y = ((const bench_sample_t *)(b))->m_ns;
+    return (x < y) - (x > y);
+}
+
+/*!
+    \brief      Returns the `q` quantile of `sorted`, which has `count` elements.
+ */
+static inline uint64_t bench_quantile(const uint64_t *sorted, size_t count, double q) {
+    size_t i = (size_t)(q * (double)(count - 1) + 0.5);
+    return sorted[i < count ? i : count - 1];
+}
+
+/*!
+    \brief      Prints one row of the percentile table for the samples
+                matching `is_free` (and `path`, unless `path` is `BENCH_PATH_COUNT`).
+ */
+static void bench_report_row(const bench_sample_t *samples, size_t count,
+                             uint8_t is_free, uint8_t path, uint64_t *scratch) {
+    size_t n = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (samples[i].m_is_free == is_free && (path == BENCH_PATH_COUNT || samples[i].m_path == path)) {
+            scratch[n++] = samples[i].m_ns;
+        }
+    }
+
+    if (n == 0) {
+        return;
+    }
+
+    qsort(scratch, n, sizeof *scratch, bench_compare_u64);
+
+    printf("%-6s %-11s %9lu %8lu %8lu %8lu %8lu %8lu %10lu\n",
+           is_free ? "free" : "malloc",
+           path == BENCH_PATH_COUNT ? "all" : bench_path_names[path],
+           (unsigned long)(n),
+           (unsigned long)(bench_quantile(scratch, n, 0.50)),
+           (unsigned long)(bench_quantile(scratch, n, 0.90)),
+           (unsigned long)(bench_quantile(scratch, n, 0.99)),
+           (unsigned long)(bench_quantile(scratch, n, 0.999)),
+           (unsigned long)(bench_quantile(scratch, n, 0.9999)),
+           (unsigned long)(scratch[n - 1]));
+}
+
+/*!
+    \brief      Program execution begins and ends here.
+
+    \param[in]  argc    Command line argument count
+    \param[in]  argv    Command line arguments
+
+    \return     0 on success, non-zero on failure
+ */
+int main(int argc, const char *argv[]) {
+    size_t operations = argc > 1 ? strtoul(argv[1], NULL, 10) : BENCH_DEFAULT_OPERATIONS;
+    size_t churn_count = argc > 2 ? strtoul(argv[2], NULL, 10) : BENCH_DEFAULT_CHURN_THREADS;
+
+    if (operations == 0 || churn_count > BENCH_MAX_CHURN_THREADS) {
+        fprintf(stderr, "usage: %s [operations > 0] [churn threads <= %d]\n", argv[0], BENCH_MAX_CHURN_THREADS);
+        return EXIT_FAILURE;
+    }
+
+    bench_sample_t *samples = calloc(operations, sizeof *samples);
+    uint64_t *scratch = calloc(operations, sizeof *scratch);
+
+    if (!samples || !scratch) {
+        fprintf(stderr, "%s: unable to allocate %lu samples\n", argv[0], (unsigned long)(operations));
+        return EXIT_FAILURE;
+    }
+
+    pthread_t churn[BENCH_MAX_CHURN_THREADS];
+
+    for (size_t i = 0; i < churn_count; ++i) {
+        pthread_create(&churn[i], NULL, bench_churn, (void *)(uintptr_t)(0x9e3779b9u * (i + 1)));
+    }
+
+    uint32_t state = 0x2545f491u;
+    void *slots[BENCH_MAIN_SLOTS] = { NULL };
+    uint32_t sizes[BENCH_MAIN_SLOTS] = { 0 };
+    size_t failures = 0;
+
+    for (size_t op = 0; op < operations; ++op) {
+        size_t i = bench_random(&state) % BENCH_MAIN_SLOTS;
+        bench_sample_t *sample = &samples[op];
+
+        size_t cached_before = bench_tcache_count();
+        long faults_before = bench_page_faults();
+        uint64_t start = 0;
+
+        if (slots[i]) {
+            sample->m_is_free = 1;
+            sample->m_size = sizes[i];
+
+            start = bench_now_ns();
+            cgcs_free(slots[i]);
+            sample->m_ns = bench_now_ns() - start;
+
+            slots[i] = NULL;
+        } else {
+            size_t size = bench_random_size(&state);
+            sample->m_size = sizes[i] = (uint32_t)(size);
+
+            start = bench_now_ns();
+            slots[i] = cgcs_malloc(size);
+            sample->m_ns = bench_now_ns() - start;
+
+            if (slots[i]) {
+                memset(slots[i], 0x5a, size);
+            } else {
+                ++failures;
+            }
+        }
+
+        if (bench_page_faults() != faults_before) {
+            sample->m_path = BENCH_PATH_PAGE_FAULT;
+        } else if (bench_tcache_count() != cached_before) {
+            sample->m_path = BENCH_PATH_TCACHE;
+        } else {
+            sample->m_path = sample->m_is_free ? BENCH_PATH_COALESCE : BENCH_PATH_SEARCH;
+        }
+    }
+
+    atomic_store(&churn_running, false);
+
+    for (size_t i = 0; i < churn_count; ++i) {
+        pthread_join(churn[i], NULL);
+    }
+
+    for (size_t i = 0; i < BENCH_MAIN_SLOTS; ++i) {
+        if (slots[i]) {
+            cgcs_free(slots[i]);
+        }
+    }
+
+    cgcs_tcache_flush();
+
+    printf("cgcs_malloc latency: %lu operations, %lu churn threads, %lu failed allocations\n\n",
+           (unsigned long)(operations), (unsigned long)(churn_count), (unsigned long)(failures));
+
+    printf("%-6s %-11s %9s %8s %8s %8s %8s %8s %10s\n",
+           "op", "path", "count", "p50 ns", "p90 ns", "p99 ns", "p99.9", "p99.99", "max ns");
+
+    for (uint8_t is_free = 0; is_free <= 1; ++is_free) {
+        bench_report_row(samples, operations, is_free, BENCH_PATH_COUNT, scratch);
+
+        for (uint8_t path = 0; path < BENCH_PATH_COUNT; ++path) {
+            bench_report_row(samples, operations, is_free, path, scratch);
+        }
+    }
+
+    /*
+        Attribute everything at or above p99.9 to the path it took.
+     */
+    for (size_t i = 0; i < operations; ++i) {
+        scratch[i] = samples[i].m_ns;
+    }
+
+    qsort(scratch, operations, sizeof *scratch, bench_compare_u64);
+    uint64_t tail = bench_quantile(scratch, operations, 0.999);
+
+    size_t tail_by_path[BENCH_PATH_COUNT] = { 0 };
+
+    for (size_t i = 0; i < operations; ++i) {
+        tail_by_path[samples[i].m_path] += samples[i].m_ns >= tail ? 1 : 0;
+    }
+
+    printf("\nOperations at or above p99.9 (%lu ns), by path:\n", (unsigned long)(tail));
+
+    for (uint8_t path = 0; path < BENCH_PATH_COUNT; ++path) {
+        printf("  %-11s %lu\n", bench_path_names[path], (unsigned long)(tail_by_path[path]));
+    }
+
+    qsort(samples, operations, sizeof *samples, bench_compare_sample_desc);
+
+    printf("\nWorst %d operations:\n", BENCH_WORST_COUNT);
+
+    for (size_t i = 0; i < BENCH_WORST_COUNT && i < operations; ++i) {
+        printf("  %10lu ns  %-6s %5lu bytes  %s\n",
+               (unsigned long)(samples[i].m_ns),
+               samples[i].m_is_free ? "free" : "malloc",
+               (unsigned long)(samples[i].m_size),
+               bench_path_names[samples[i].m_path]);
+    }
+
+    free(scratch);
+    free(samples);
+
+    return EXIT_SUCCESS;
+}
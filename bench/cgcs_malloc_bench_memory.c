@@ -0,0 +1,367 @@
+/*!
+    \file       cgcs_malloc_bench_memory.c
+    \brief      Benchmark for cgcs_malloc: memory overhead against requested bytes
+
+    \details
+    Each workload fills the heap to a target of live requested bytes,
+    churns it (frees a random allocation, allocates a new one), then frees
+    everything. At the peak, it relates what the allocator holds to the
+    bytes that were actually requested:
+
+    - `reserved`    usable bytes of the live blocks -- rounding and unsplit slack
+    - `footprint`   committed bytes of `block`, plus the large mappings,
+                    live or cached (`cgcs_heap_summary`) -- adds headers,
+                    fragmentation and cached mappings
+    - `peak RSS`    resident memory of the process, less its resident memory
+                    before the workload -- adds whatever pages were touched
+
+    Every workload runs in a child process of its own, so that each one starts
+    from an empty heap, and its peak RSS is its own (`wait4`).
+
+    Usage: cgcs_malloc_bench_memory [target live MiB]
+
+    \author     Gemuele Aludino
+    \date       18 Oct 2026
+ */
+
+#include "cgcs_malloc_bench.h"
+#include "cgcs_malloc.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BENCH_DEFAULT_TARGET_MIB    1
+#define BENCH_SAMPLE_PERIOD         256                   //!< operations between footprint samples
+
+/*!
+    \enum       bench_pattern
+    \brief      How a workload allocates and frees
+ */
+enum bench_pattern {
+    BENCH_PATTERN_CHURN,        //!< fill, then replace random allocations with new ones
+    BENCH_PATTERN_FRAGMENT      //!< fill with small objects, free every other one, refill with larger ones
+};
+
+/*!
+    \typedef    bench_workload_t
+    \brief      A size distribution and allocation pattern
+ */
+typedef struct bench_workload {
+    const char *m_name;
+    size_t m_min_size;
+    size_t m_max_size;
+    enum bench_pattern m_pattern;
+} bench_workload_t;
+
+static const bench_workload_t bench_workloads[] = {
+    { "tiny",       8,      64,                 BENCH_PATTERN_CHURN },
+    { "small",      64,     512,                BENCH_PATTERN_CHURN },
+    { "medium",     512,    16384,              BENCH_PATTERN_CHURN },
+    { "mixed",      8,      65536,              BENCH_PATTERN_CHURN },
+    { "large",      65536,  (size_t)(4) << 20,  BENCH_PATTERN_CHURN },
+    { "fragment",   16,     128,                BENCH_PATTERN_FRAGMENT }
+};
+
+/*!
+    \typedef    bench_slot_t
+    \brief      One live allocation of a workload
+ */
+typedef struct bench_slot {
+    void *m_ptr;
+    size_t m_size;
+} bench_slot_t;
+
+/*!
+    \typedef    bench_result_t
+    \brief      Peaks measured by a workload's child process
+ */
+typedef struct bench_result {
+    uint64_t m_requested;       //! peak live requested bytes
+    uint64_t m_reserved;        //! peak live usable bytes
+    uint64_t m_footprint;       //! peak committed bytes of `block` plus large mappings
+    uint64_t m_baseline_rss;    //! resident bytes before the workload
+    uint64_t m_failures;        //! failed allocations
+} bench_result_t;
+
+/*!
+    \typedef    bench_state_t
+    \brief      Live allocations and running totals of a workload
+ */
+typedef struct bench_state {
+    bench_slot_t *m_slots;
+    size_t m_count;
+    size_t m_capacity;
+    uint64_t m_requested;       //! live requested bytes
+    uint64_t m_large;           //! bytes of large mappings, live or cached, as last sampled
+    uint64_t m_committed;       //! committed bytes of `block`, as last sampled
+    uint64_t m_operations;
+    uint32_t m_random;
+    bench_result_t m_result;
+} bench_state_t;
+
+/*!
+    \brief      Draws a size within [`min_size`, `max_size`], log-uniformly:
+                every power-of-two range is equally likely.
+ */
+static size_t bench_random_size(uint32_t *state, size_t min_size, size_t max_size) {
+    size_t low = 0;
+    size_t high = 0;
+
+    while (((size_t)(2) << low) <= min_size) {
+        ++low;
+    }
+
+    while (((size_t)(2) << high) <= max_size) {
+        ++high;
+    }
+
+    size_t k = low + bench_random(state) % (high - low + 1);
+    size_t size = ((size_t)(1) << k) + bench_random(state) % ((size_t)(1) << k);
+
+    return size < min_size ? min_size : size > max_size ? max_size : size;
+}
+
+/*!
+    \brief      Returns a field of /proc/self/status, such as `VmRSS`, in bytes;
+                0 if it cannot be read.
+ */
+static uint64_t bench_status_bytes(const char *field) {
+    FILE *f = fopen("/proc/self/status", "r");
+    char line[128];
+    unsigned long long kib = 0;
+    size_t length = strlen(field);
+
+    while (f && fgets(line, sizeof line, f)) {
+        if (strncmp(line, field, length) == 0 && line[length] == ':') {
+            sscanf(line + length + 1, "%llu", &kib);
+            break;
+        }
+    }
+
+    if (f) {
+        fclose(f);
+    }
+
+    return (uint64_t)(kib) * 1024;
+}
+
+/*!
+    \brief      Updates the peaks of `self`. The reserved bytes are read
+                from the statistics after every allocation; the committed
+                bytes of `block`, which take a walk of the heap, only every
+                `BENCH_SAMPLE_PERIOD` allocations, or when `force`.
+ */
+static void bench_sample(bench_state_t *self, bool force) {
+    cgcs_stats_t stats;
+    cgcs_stats_read(&stats);
+
+    uint64_t reserved = stats.m_bytes_allocated - stats.m_bytes_freed;
+
+    self->m_result.m_requested = self->m_requested > self->m_result.m_requested ?
+                                     self->m_requested : self->m_result.m_requested;
+    self->m_result.m_reserved = reserved > self->m_result.m_reserved ? reserved : self->m_result.m_reserved;
+
+    if (force || ++self->m_operations % BENCH_SAMPLE_PERIOD == 0) {
+        cgcs_heap_summary_t summary;
+        cgcs_heap_summary(&summary);
+        self->m_committed = summary.m_committed;
+        self->m_large = summary.m_large_bytes + summary.m_large_cached;
+    }
+
+    uint64_t footprint = self->m_committed + self->m_large;
+    self->m_result.m_footprint = footprint > self->m_result.m_footprint ? footprint : self->m_result.m_footprint;
+}
+
+/*!
+    \brief      Allocates `size` bytes into the next slot, and touches every byte of it.
+ */
+static void bench_allocate(bench_state_t *self, size_t size) {
+    void *ptr = cgcs_malloc(size);
+
+    if (!ptr) {
+        ++self->m_result.m_failures;
+        return;
+    }
+
+    memset(ptr, 0xa5, size);
+
+    self->m_slots[self->m_count++] = (bench_slot_t){ ptr, size };
+    self->m_requested += size;
+
+    // A large allocation moves the footprint by at least a mapping: sample it at once.
+    bench_sample(self, size >= CGCS_MALLOC_LARGE_SIZE);
+}
+
+/*!
+    \brief      Frees the allocation in slot `i`, moving the last slot into its place.
+ */
+static void bench_release(bench_state_t *self, size_t i) {
+    bench_slot_t slot = self->m_slots[i];
+
+    cgcs_free(slot.m_ptr);
+
+    self->m_slots[i] = self->m_slots[--self->m_count];
+    self->m_requested -= slot.m_size;
+}
+
+/*!
+    \brief      Runs one workload to completion and returns its peaks.
+                Called in a child process of its own.
+ */
+static bench_result_t bench_run(const bench_workload_t *workload, uint64_t target) {
+    bench_state_t self;
+    memset(&self, 0, sizeof self);
+
+    self.m_capacity = (size_t)(target / workload->m_min_size) + 1;
+    self.m_slots = calloc(self.m_capacity, sizeof *self.m_slots);
+    self.m_random = 0x2545f491;
+
+    if (!self.m_slots) {
+        self.m_result.m_failures = 1;
+        return self.m_result;
+    }
+
+    // The bookkeeping is resident before the baseline is taken.
+    memset(self.m_slots, 0, self.m_capacity * sizeof *self.m_slots);
+    self.m_result.m_baseline_rss = bench_status_bytes("VmRSS");
+
+    while (self.m_requested < target && self.m_count < self.m_capacity && self.m_result.m_failures == 0) {
+        bench_allocate(&self, bench_random_size(&self.m_random, workload->m_min_size, workload->m_max_size));
+    }
+
+    if (workload->m_pattern == BENCH_PATTERN_CHURN) {
+        size_t churn = self.m_count;
+
+        for (size_t op = 0; op < churn && self.m_count > 0; ++op) {
+            bench_release(&self, bench_random(&self.m_random) % self.m_count);
+            bench_allocate(&self, bench_random_size(&self.m_random, workload->m_min_size, workload->m_max_size));
+        }
+    } else {
+        /*
+            Free every other small object (in address order, roughly),
+            then bring the live bytes back up with objects too large
+            for the holes that were left.
+         */
+        for (size_t i = self.m_count; i-- > 0;) {
+            if (i % 2 == 0) {
+                bench_release(&self, i);
+            }
+        }
+
+        while (self.m_requested < target && self.m_count < self.m_capacity && self.m_result.m_failures == 0) {
+            bench_allocate(&self, bench_random_size(&self.m_random, workload->m_max_size * 2, workload->m_max_size * 16));
+        }
+    }
+
+    bench_sample(&self, true);
+
+    while (self.m_count > 0) {
+        bench_release(&self, self.m_count - 1);
+    }
+
+    free(self.m_slots);
+    return self.m_result;
+}
+
+/*!
+    \brief      Prints a ratio of `value` to `requested`, or `-` if there is none.
+ */
+static void bench_print_ratio(uint64_t value, uint64_t requested) {
+    if (requested > 0) {
+        printf(" %9.3f", (double)(value) / (double)(requested));
+    } else {
+        printf(" %9s", "-");
+    }
+}
+
+/*!
+    \brief      Program execution begins and ends here.
+
+    \param[in]  argc    Command line argument count
+    \param[in]  argv    Command line arguments
+
+    \return     0 on success, non-zero on failure
+ */
+int main(int argc, const char *argv[]) {
+    size_t target_mib = argc > 1 ? strtoul(argv[1], NULL, 10) : BENCH_DEFAULT_TARGET_MIB;
+
+    if (target_mib == 0 || target_mib > 512) {
+        fprintf(stderr, "usage: %s [target live MiB, within [1, 512]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    uint64_t target = (uint64_t)(target_mib) << 20;
+
+    printf("cgcs_malloc memory efficiency: %lu MiB of live requested bytes per workload\n\n",
+           (unsigned long)(target_mib));
+    printf("%-9s %12s %12s %12s %12s %9s %9s %9s\n",
+           "workload", "requested", "reserved", "footprint", "peak RSS", "reserved", "footprnt", "RSS");
+    printf("%-9s %12s %12s %12s %12s %9s %9s %9s\n",
+           "", "(KiB)", "(KiB)", "(KiB)", "(KiB)", "/ req", "/ req", "/ req");
+
+    for (size_t w = 0; w < sizeof bench_workloads / sizeof *bench_workloads; ++w) {
+        int channel[2];
+
+        fflush(stdout);
+
+        if (pipe(channel) != 0) {
+            fprintf(stderr, "%s: unable to create a pipe\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        pid_t child = fork();
+
+        if (child < 0) {
+            fprintf(stderr, "%s: unable to fork\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        if (child == 0) {
+            close(channel[0]);
+
+            bench_result_t result = bench_run(&bench_workloads[w], target);
+            ssize_t written = write(channel[1], &result, sizeof result);
+
+            _exit(written == (ssize_t)(sizeof result) ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+
+        close(channel[1]);
+
+        bench_result_t result;
+        ssize_t received = read(channel[0], &result, sizeof result);
+        struct rusage usage;
+        int status = 0;
+
+        close(channel[0]);
+
+        if (wait4(child, &status, 0, &usage) != child || received != (ssize_t)(sizeof result)
+        || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            fprintf(stderr, "%s: workload %s did not complete\n", argv[0], bench_workloads[w].m_name);
+            return EXIT_FAILURE;
+        }
+
+        uint64_t peak_rss = (uint64_t)(usage.ru_maxrss) * 1024;    // ru_maxrss is in KiB on Linux
+        uint64_t rss = peak_rss > result.m_baseline_rss ? peak_rss - result.m_baseline_rss : 0;
+
+        printf("%-9s %12llu %12llu %12llu %12llu", bench_workloads[w].m_name,
+               (unsigned long long)(result.m_requested >> 10), (unsigned long long)(result.m_reserved >> 10),
+               (unsigned long long)(result.m_footprint >> 10), (unsigned long long)(rss >> 10));
+
+        bench_print_ratio(result.m_reserved, result.m_requested);
+        bench_print_ratio(result.m_footprint, result.m_requested);
+        bench_print_ratio(rss, result.m_requested);
+
+        if (result.m_failures > 0) {
+            printf("  (%llu failed allocations)", (unsigned long long)(result.m_failures));
+        }
+
+        printf("\n");
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,370 @@
+/*!
+    \file       cgcs_malloc_bench_realloc.c
+    \brief      Benchmark for cgcs_malloc: growing and shrinking buffers
+
+    \details
+    Three patterns that reallocate a lot, each run with three strategies:
+
+    - `vector`      8-byte elements appended one at a time; capacity doubles
+    - `string`      chunks of 1 to 32 bytes appended; capacity grows by half
+    - `shrink`      buffers built to random lengths, then shrunk to fit,
+                    with the last few kept alive
+
+    - `move`        allocate the new capacity, copy, free the old block --
+                    what a `realloc` without in-place growth does
+    - `good size`   the same, but every capacity is `cgcs_good_size` of it,
+                    so rounding slack is used before the next move
+    - `expand`      `good size`, trying `cgcs_try_expand` before every move
+
+    The vector and string patterns grow several buffers round-robin,
+    so that they get in each other's way. Every pattern and strategy
+    runs in a child process of its own, from an empty heap.
+
+    Reported are the moves, the bytes they copied, the copies avoided
+    against `move`, and the time per operation. Moves of large mappings
+    are counted apart: they are what `mremap` would avoid.
+
+    Usage: cgcs_malloc_bench_realloc [buffer MiB]
+
+    \author     Gemuele Aludino
+    \date       18 Oct 2026
+ */
+
+#include "cgcs_malloc_bench.h"
+#include "cgcs_malloc.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BENCH_DEFAULT_BUFFER_MIB    4
+#define BENCH_MAX_BUFFER_MIB        256
+
+#define BENCH_BUFFER_COUNT          4       //!< buffers grown round-robin by `vector` and `string`
+#define BENCH_SHRINK_LIVE           64      //!< shrunk buffers kept alive by `shrink`
+#define BENCH_SHRINK_MAX_LENGTH     65536   //!< longest buffer built by `shrink`
+#define BENCH_MAX_CHUNK             32      //!< longest chunk appended by `string` and `shrink`
+
+/*!
+    \enum       bench_pattern
+    \brief      How the buffers of a run are grown
+ */
+enum bench_pattern {
+    BENCH_PATTERN_VECTOR,
+    BENCH_PATTERN_STRING,
+    BENCH_PATTERN_SHRINK,
+    BENCH_PATTERN_COUNT
+};
+
+static const char *bench_pattern_names[BENCH_PATTERN_COUNT] = {
+    "vector", "string", "shrink"
+};
+
+/*!
+    \enum       bench_strategy
+    \brief      How a buffer gets more (or less) capacity
+ */
+enum bench_strategy {
+    BENCH_STRATEGY_MOVE,
+    BENCH_STRATEGY_GOOD_SIZE,
+    BENCH_STRATEGY_EXPAND,
+    BENCH_STRATEGY_COUNT
+};
+
+static const char *bench_strategy_names[BENCH_STRATEGY_COUNT] = {
+    "move", "good size", "expand"
+};
+
+/*!
+    \typedef    bench_buffer_t
+    \brief      A growable byte buffer
+ */
+typedef struct bench_buffer {
+    char *m_data;
+    size_t m_length;
+    size_t m_capacity;
+} bench_buffer_t;
+
+/*!
+    \typedef    bench_result_t
+    \brief      Counters of one pattern and strategy, measured by a child process
+ */
+typedef struct bench_result {
+    uint64_t m_operations;      //! appends and shrinks
+    uint64_t m_resizes;         //! capacity changes
+    uint64_t m_expansions;      //! resizes done in place by `cgcs_try_expand`
+    uint64_t m_moves;           //! resizes that copied the contents
+    uint64_t m_bytes_moved;
+    uint64_t m_large_moves;     //! moves out of a large mapping
+    uint64_t m_large_bytes_moved;
+    uint64_t m_failures;
+    uint64_t m_ns;
+} bench_result_t;
+
+/*!
+    \brief      Gives `self` a capacity of `capacity` bytes, at least its length,
+                the way `strategy` does it.
+
+    \return     `true` on success, `false` if memory could not be allocated.
+ */
+static bool bench_resize(bench_buffer_t *self, size_t capacity, enum bench_strategy strategy,
+                         bench_result_t *result) {
+    if (strategy == BENCH_STRATEGY_EXPAND && self->m_data && capacity > self->m_capacity) {
+        size_t expanded = cgcs_try_expand(self->m_data, capacity, capacity);
+
+        if (expanded > 0) {
+            self->m_capacity = expanded;
+            ++result->m_resizes;
+            ++result->m_expansions;
+            return true;
+        }
+    }
+
+    size_t size = strategy == BENCH_STRATEGY_MOVE ? capacity : cgcs_good_size(capacity);
+    char *data = cgcs_malloc(size);
+
+    if (!data) {
+        ++result->m_failures;
+        return false;
+    }
+
+    if (self->m_data) {
+        memcpy(data, self->m_data, self->m_length);
+
+        ++result->m_moves;
+        result->m_bytes_moved += self->m_length;
+
+        if (self->m_capacity >= CGCS_MALLOC_LARGE_SIZE) {
+            ++result->m_large_moves;
+            result->m_large_bytes_moved += self->m_length;
+        }
+
+        cgcs_free(self->m_data);
+    }
+
+    self->m_data = data;
+    self->m_capacity = size;
+    ++result->m_resizes;
+
+    return true;
+}
+
+/*!
+    \brief      Appends `length` bytes to `self`, growing its capacity
+                by the policy of `pattern` if they do not fit.
+
+    \return     `true` on success, `false` if memory could not be allocated.
+ */
+static bool bench_append(bench_buffer_t *self, const char *bytes, size_t length, enum bench_pattern pattern,
+                         enum bench_strategy strategy, bench_result_t *result) {
+    size_t needed = self->m_length + length;
+    ++result->m_operations;
+
+    if (needed > self->m_capacity) {
+        size_t capacity = pattern == BENCH_PATTERN_VECTOR ?
+                              self->m_capacity * 2 : self->m_capacity + self->m_capacity / 2;
+
+        capacity = capacity > needed ? capacity : needed;
+        capacity = capacity > 16 ? capacity : 16;
+
+        if (!bench_resize(self, capacity, strategy, result)) {
+            return false;
+        }
+    }
+
+    memcpy(self->m_data + self->m_length, bytes, length);
+    self->m_length = needed;
+
+    return true;
+}
+
+/*!
+    \brief      Shrinks the capacity of `self` to its length -- unless,
+                for every strategy but `move`, that would not give back anything.
+ */
+static void bench_shrink(bench_buffer_t *self, enum bench_strategy strategy, bench_result_t *result) {
+    ++result->m_operations;
+
+    size_t fit = strategy == BENCH_STRATEGY_MOVE ? self->m_length : cgcs_good_size(self->m_length);
+
+    if (self->m_length > 0 && fit < self->m_capacity) {
+        bench_resize(self, self->m_length, strategy, result);
+    }
+}
+
+/*!
+    \brief      Releases the storage of `self`.
+ */
+static void bench_release(bench_buffer_t *self) {
+    if (self->m_data) {
+        cgcs_free(self->m_data);
+    }
+
+    memset(self, 0, sizeof *self);
+}
+
+/*!
+    \brief      Runs one pattern with one strategy and returns its counters.
+                Called in a child process of its own.
+ */
+static bench_result_t bench_run(enum bench_pattern pattern, enum bench_strategy strategy, size_t buffer_size) {
+    bench_result_t result;
+    bench_buffer_t buffers[BENCH_SHRINK_LIVE];
+    char bytes[BENCH_MAX_CHUNK];
+    uint32_t state = 0x2545f491u;
+
+    memset(&result, 0, sizeof result);
+    memset(buffers, 0, sizeof buffers);
+    memset(bytes, 0xa5, sizeof bytes);
+
+    uint64_t start = bench_now_ns();
+
+    if (pattern == BENCH_PATTERN_SHRINK) {
+        size_t rounds = buffer_size / (BENCH_SHRINK_MAX_LENGTH / 2) * BENCH_BUFFER_COUNT;
+
+        for (size_t r = 0; r < rounds && result.m_failures == 0; ++r) {
+            bench_buffer_t *self = &buffers[r % BENCH_SHRINK_LIVE];
+            size_t length = 1 + bench_random(&state) % BENCH_SHRINK_MAX_LENGTH;
+
+            bench_release(self);
+
+            while (self->m_length < length && result.m_failures == 0) {
+                size_t chunk = 1 + bench_random(&state) % BENCH_MAX_CHUNK;
+                chunk = chunk < length - self->m_length ? chunk : length - self->m_length;
+
+                bench_append(self, bytes, chunk, BENCH_PATTERN_VECTOR, strategy, &result);
+            }
+
+            bench_shrink(self, strategy, &result);
+        }
+    } else {
+        bool growing = true;
+
+        while (growing && result.m_failures == 0) {
+            growing = false;
+
+            for (size_t b = 0; b < BENCH_BUFFER_COUNT; ++b) {
+                if (buffers[b].m_length >= buffer_size) {
+                    continue;
+                }
+
+                size_t chunk = pattern == BENCH_PATTERN_VECTOR ? sizeof(uint64_t) :
+                                                                 1 + bench_random(&state) % BENCH_MAX_CHUNK;
+
+                bench_append(&buffers[b], bytes, chunk, pattern, strategy, &result);
+                growing = true;
+            }
+        }
+    }
+
+    result.m_ns = bench_now_ns() - start;
+
+    for (size_t b = 0; b < BENCH_SHRINK_LIVE; ++b) {
+        bench_release(&buffers[b]);
+    }
+
+    return result;
+}
+
+/*!
+    \brief      Runs `bench_run` in a child process.
+
+    \return     `true` if the child completed, `false` otherwise.
+ */
+static bool bench_run_child(enum bench_pattern pattern, enum bench_strategy strategy, size_t buffer_size,
+                            bench_result_t *result) {
+    int channel[2];
+
+    fflush(stdout);
+
+    if (pipe(channel) != 0) {
+        return false;
+    }
+
+    pid_t child = fork();
+
+    if (child < 0) {
+        close(channel[0]);
+        close(channel[1]);
+        return false;
+    }
+
+    if (child == 0) {
+        close(channel[0]);
+
+        bench_result_t measured = bench_run(pattern, strategy, buffer_size);
+        ssize_t written = write(channel[1], &measured, sizeof measured);
+
+        _exit(written == (ssize_t)(sizeof measured) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    close(channel[1]);
+
+    ssize_t received = read(channel[0], result, sizeof *result);
+    int status = 0;
+
+    close(channel[0]);
+
+    return waitpid(child, &status, 0) == child && received == (ssize_t)(sizeof *result)
+        && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+}
+
+/*!
+    \brief      Program execution begins and ends here.
+
+    \param[in]  argc    Command line argument count
+    \param[in]  argv    Command line arguments
+
+    \return     0 on success, non-zero on failure
+ */
+int main(int argc, const char *argv[]) {
+    size_t buffer_mib = argc > 1 ? strtoul(argv[1], NULL, 10) : BENCH_DEFAULT_BUFFER_MIB;
+
+    if (buffer_mib == 0 || buffer_mib > BENCH_MAX_BUFFER_MIB) {
+        fprintf(stderr, "usage: %s [buffer MiB, within [1, %d]]\n", argv[0], BENCH_MAX_BUFFER_MIB);
+        return EXIT_FAILURE;
+    }
+
+    size_t buffer_size = buffer_mib << 20;
+
+    printf("cgcs_malloc realloc patterns: %d buffers of %lu MiB; shrink: buffers of up to %d bytes\n\n",
+           BENCH_BUFFER_COUNT, (unsigned long)(buffer_mib), BENCH_SHRINK_MAX_LENGTH);
+    printf("%-7s %-10s %10s %8s %8s %8s %8s %12s %8s %12s %8s\n",
+           "pattern", "strategy", "ops", "resizes", "in place", "moves", "avoided",
+           "KiB moved", "large", "large KiB", "ns/op");
+
+    for (int p = 0; p < BENCH_PATTERN_COUNT; ++p) {
+        bench_result_t results[BENCH_STRATEGY_COUNT];
+
+        for (int s = 0; s < BENCH_STRATEGY_COUNT; ++s) {
+            if (!bench_run_child(p, s, buffer_size, &results[s])) {
+                fprintf(stderr, "%s: %s with %s did not complete\n",
+                        argv[0], bench_pattern_names[p], bench_strategy_names[s]);
+                return EXIT_FAILURE;
+            }
+
+            const bench_result_t *r = &results[s];
+            int64_t avoided = (int64_t)(results[BENCH_STRATEGY_MOVE].m_moves) - (int64_t)(r->m_moves);
+
+            printf("%-7s %-10s %10llu %8llu %8llu %8llu %+8lld %12llu %8llu %12llu %8.1f",
+                   bench_pattern_names[p], bench_strategy_names[s],
+                   (unsigned long long)(r->m_operations), (unsigned long long)(r->m_resizes),
+                   (unsigned long long)(r->m_expansions), (unsigned long long)(r->m_moves), (long long)(avoided),
+                   (unsigned long long)(r->m_bytes_moved >> 10), (unsigned long long)(r->m_large_moves),
+                   (unsigned long long)(r->m_large_bytes_moved >> 10),
+                   r->m_operations ? (double)(r->m_ns) / (double)(r->m_operations) : 0.0);
+
+            if (r->m_failures > 0) {
+                printf("  (%llu failed allocations)", (unsigned long long)(r->m_failures));
+            }
+
+            printf("\n");
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,456 @@
+/*!
+    \file       cgcs_malloc_bench_startup.c
+    \brief      Benchmark for cgcs_malloc: process startup and first-allocation cost
+
+    \details
+    Short-lived processes pay for what the allocator sets up lazily.
+    The benchmark runs itself as a child process many times, and reports
+    the median of every measurement over the runs:
+
+    - `startup`     wall time from spawning the child until it exits,
+                    without any allocation, and with a single allocation,
+                    as minimum, median and spread (10th to 90th percentile);
+                    their difference is printed only when it exceeds the
+                    spread, since spawning alone varies by far more than
+                    one allocation costs
+    - `share`       the allocator's share of startup, timed inside the
+                    child around its first `cgcs_malloc` and the first
+                    touch of the block
+    - `first`       the first `cgcs_malloc` of a thread, and of every size
+                    in a fresh process -- `mem_initialize`, the statistics
+                    slot and thread cache registration, first use of a
+                    size class, the first large mapping
+    - `next`        the same request, right after the first was freed
+    - `faults`      page faults taken by the call, and by writing every
+                    byte of the allocation afterwards (first touch)
+
+    Usage: cgcs_malloc_bench_startup [runs]
+
+    \author     Gemuele Aludino
+    \date       18 Oct 2026
+ */
+
+#include "cgcs_malloc_bench.h"
+#include "cgcs_malloc.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <pthread.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BENCH_DEFAULT_RUNS      100
+#define BENCH_MAX_RUNS          10000
+#define BENCH_MIN_SPREAD_RUNS   10      //!< fewest runs whose spread tells a difference from noise
+#define BENCH_SELF              "/proc/self/exe"
+
+#ifdef RUSAGE_THREAD
+#define BENCH_RUSAGE_WHO RUSAGE_THREAD
+#else
+#define BENCH_RUSAGE_WHO RUSAGE_SELF
+#endif /* RUSAGE_THREAD */
+
+extern char **environ;
+
+/*!
+    \typedef    bench_probe_t
+    \brief      An allocation timed by a child, the first time and the next
+ */
+typedef struct bench_probe {
+    const char *m_name;
+    size_t m_size;
+    bool m_new_thread;      //! made by a thread of its own, after the main thread's probes
+} bench_probe_t;
+
+static const bench_probe_t bench_probes[] = {
+    { "first allocation",       16,                 false },
+    { "class 8",                8,                  false },
+    { "class 32",               32,                 false },
+    { "class 64",               64,                 false },
+    { "small",                  256,                false },
+    { "page",                   4096,               false },
+    { "medium",                 65536,              false },
+    { "large",                  (size_t)(1) << 20,  false },
+    { "large, 8 MiB",           (size_t)(8) << 20,  false },
+    { "new thread",             16,                 true },
+    { "new thread, class 64",   64,                 true }
+};
+
+#define BENCH_PROBE_COUNT (sizeof bench_probes / sizeof *bench_probes)
+
+/*!
+    \typedef    bench_timing_t
+    \brief      One allocation as measured by a child
+ */
+typedef struct bench_timing {
+    uint64_t m_malloc_ns;
+    uint64_t m_touch_ns;
+    long m_malloc_faults;
+    long m_touch_faults;
+} bench_timing_t;
+
+/*!
+    \typedef    bench_result_t
+    \brief      Everything one child measures; written to its standard output
+ */
+typedef struct bench_result {
+    bench_timing_t m_first[BENCH_PROBE_COUNT];
+    bench_timing_t m_next[BENCH_PROBE_COUNT];
+    uint64_t m_failures;
+} bench_result_t;
+
+/*!
+    \brief      Returns the page faults taken so far by the calling thread.
+ */
+static inline long bench_page_faults() {
+    struct rusage usage;
+    getrusage(BENCH_RUSAGE_WHO, &usage);
+    return usage.ru_minflt + usage.ru_majflt;
+}
+
+/*!
+    \brief      Allocates `size` bytes, writes every byte, and frees them,
+                timing the allocation and the writes separately.
+
+    \return     `true` on success, `false` if the allocation failed.
+ */
+static bool bench_time(size_t size, bench_timing_t *timing) {
+    long faults = bench_page_faults();
+    uint64_t start = bench_now_ns();
+
+    char *ptr = cgcs_malloc(size);
+
+    timing->m_malloc_ns = bench_now_ns() - start;
+    timing->m_malloc_faults = bench_page_faults() - faults;
+
+    if (!ptr) {
+        return false;
+    }
+
+    faults = bench_page_faults();
+    start = bench_now_ns();
+
+    memset(ptr, 0xa5, size);
+
+    timing->m_touch_ns = bench_now_ns() - start;
+    timing->m_touch_faults = bench_page_faults() - faults;
+
+    cgcs_free(ptr);
+    return true;
+}
+
+/*!
+    \brief      Times the probes of the main thread (`new_thread == false`)
+                or of a new thread, into `result`.
+ */
+static void bench_probe_all(bench_result_t *result, bool new_thread) {
+    for (size_t i = 0; i < BENCH_PROBE_COUNT; ++i) {
+        if (bench_probes[i].m_new_thread != new_thread) {
+            continue;
+        }
+
+        if (!bench_time(bench_probes[i].m_size, &result->m_first[i])
+        || !bench_time(bench_probes[i].m_size, &result->m_next[i])) {
+            ++result->m_failures;
+        }
+    }
+}
+
+/*!
+    \brief      Thread of a child that makes the `m_new_thread` probes.
+
+    \param[in]  arg     the child's `bench_result_t`
+
+    \return     `NULL`
+ */
+static void *bench_thread(void *arg) {
+    bench_probe_all(arg, true);
+    return NULL;
+}
+
+/*!
+    \brief      Body of a child process: times every probe in order
+                and writes the result to the standard output.
+
+    \return     0 on success, non-zero on failure
+ */
+static int bench_child() {
+    bench_result_t result;
+    memset(&result, 0, sizeof result);
+
+    bench_probe_all(&result, false);
+
+    pthread_t thread;
+
+    if (pthread_create(&thread, NULL, bench_thread, &result) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    pthread_join(thread, NULL);
+
+    return write(STDOUT_FILENO, &result, sizeof result) == (ssize_t)(sizeof result) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*!
+    \brief      Body of a child process for the startup measurement:
+                exits at once, after a single allocation if `allocate`.
+ */
+static int bench_child_startup(bool allocate) {
+    if (allocate) {
+        void *ptr = cgcs_malloc(16);
+
+        if (!ptr) {
+            return EXIT_FAILURE;
+        }
+
+        cgcs_free(ptr);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*!
+    \brief      Spawns this program with `mode` as its argument,
+                and waits for it to exit.
+
+    \param[in]  mode        `probe`, `empty` or `one`
+    \param[out] result      Receives the result of a `probe` child, or `NULL`
+    \param[out] elapsed_ns  Receives the time from the spawn to the exit
+
+    \return     `true` if the child ran successfully, `false` otherwise.
+ */
+static bool bench_spawn(const char *mode, bench_result_t *result, uint64_t *elapsed_ns) {
+    int channel[2];
+
+    if (pipe(channel) != 0) {
+        return false;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, channel[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&actions, channel[0]);
+
+    char *const args[] = { (char *)(BENCH_SELF), (char *)(mode), NULL };
+    pid_t child = 0;
+    uint64_t start = bench_now_ns();
+    bool spawned = posix_spawn(&child, BENCH_SELF, &actions, NULL, args, environ) == 0;
+
+    posix_spawn_file_actions_destroy(&actions);
+    close(channel[1]);
+
+    ssize_t received = result ? read(channel[0], result, sizeof *result) : 0;
+    int status = 0;
+    bool exited = spawned && waitpid(child, &status, 0) == child;
+
+    *elapsed_ns = bench_now_ns() - start;
+    close(channel[0]);
+
+    return exited && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS
+        && (!result || received == (ssize_t)(sizeof *result));
+}
+
+/*!
+    \brief      `qsort` comparator for `uint64_t`, ascending.
+ */
+static int bench_compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)(a);
+    uint64_t y = *(const uint64_t *)(b);
+    return (x > y) - (x < y);
+}
+
+/*!
+    \brief      Sorts `values` and returns their median.
+ */
+static uint64_t bench_median(uint64_t *values, size_t count) {
+    qsort(values, count, sizeof *values, bench_compare_u64);
+    return values[count / 2];
+}
+
+/*!
+    \typedef    bench_spread_t
+    \brief      Distribution of a measurement over the runs
+ */
+typedef struct bench_spread {
+    uint64_t m_min;
+    uint64_t m_median;
+    uint64_t m_spread;      //! 90th minus 10th percentile
+} bench_spread_t;
+
+/*!
+    \brief      Sorts `values` and returns their distribution.
+ */
+static bench_spread_t bench_distribution(uint64_t *values, size_t count) {
+    bench_spread_t spread;
+
+    spread.m_median = bench_median(values, count);
+    spread.m_min = values[0];
+    spread.m_spread = values[count * 9 / 10] - values[count / 10];
+
+    return spread;
+}
+
+/*!
+    \brief      Prints one row of the startup table, in microseconds.
+ */
+static void bench_report_spread(const char *name, bench_spread_t spread) {
+    printf("%-34s %10.1f %10.1f %10.1f\n", name,
+           (double)(spread.m_min) / 1000.0, (double)(spread.m_median) / 1000.0, (double)(spread.m_spread) / 1000.0);
+}
+
+/*!
+    \enum       bench_field
+    \brief      A field of `bench_timing_t`, for `bench_field_median`
+ */
+enum bench_field {
+    BENCH_FIELD_MALLOC_NS,
+    BENCH_FIELD_MALLOC_FAULTS,
+    BENCH_FIELD_TOUCH_NS,
+    BENCH_FIELD_TOUCH_FAULTS
+};
+
+/*!
+    \brief      Returns the median over every run of one field of probe `i`,
+                as timed the first time or (`next`) the second time.
+ */
+static uint64_t bench_field_median(const bench_result_t *results, size_t runs, size_t i, bool next,
+                                   enum bench_field field, uint64_t *scratch) {
+    for (size_t r = 0; r < runs; ++r) {
+        const bench_timing_t *timing = next ? &results[r].m_next[i] : &results[r].m_first[i];
+
+        switch (field) {
+        case BENCH_FIELD_MALLOC_NS:
+            scratch[r] = timing->m_malloc_ns;
+            break;
+        case BENCH_FIELD_MALLOC_FAULTS:
+            scratch[r] = (uint64_t)(timing->m_malloc_faults);
+            break;
+        case BENCH_FIELD_TOUCH_NS:
+            scratch[r] = timing->m_touch_ns;
+            break;
+        case BENCH_FIELD_TOUCH_FAULTS:
+            scratch[r] = (uint64_t)(timing->m_touch_faults);
+            break;
+        }
+    }
+
+    return bench_median(scratch, runs);
+}
+
+/*!
+    \brief      Prints the medians of probe `i`, first and next.
+ */
+static void bench_report_probe(const bench_result_t *results, size_t runs, size_t i, uint64_t *scratch) {
+    printf("%-22s %9lu %10lu %7lu %10lu %7lu %10lu %7lu\n", bench_probes[i].m_name,
+           (unsigned long)(bench_probes[i].m_size),
+           (unsigned long)(bench_field_median(results, runs, i, false, BENCH_FIELD_MALLOC_NS, scratch)),
+           (unsigned long)(bench_field_median(results, runs, i, false, BENCH_FIELD_MALLOC_FAULTS, scratch)),
+           (unsigned long)(bench_field_median(results, runs, i, false, BENCH_FIELD_TOUCH_NS, scratch)),
+           (unsigned long)(bench_field_median(results, runs, i, false, BENCH_FIELD_TOUCH_FAULTS, scratch)),
+           (unsigned long)(bench_field_median(results, runs, i, true, BENCH_FIELD_MALLOC_NS, scratch)),
+           (unsigned long)(bench_field_median(results, runs, i, true, BENCH_FIELD_MALLOC_FAULTS, scratch)));
+}
+
+/*!
+    \brief      Program execution begins and ends here.
+
+    \param[in]  argc    Command line argument count
+    \param[in]  argv    Command line arguments
+
+    \return     0 on success, non-zero on failure
+ */
+int main(int argc, const char *argv[]) {
+    if (argc == 2 && strcmp(argv[1], "probe") == 0) {
+        return bench_child();
+    } else if (argc == 2 && (strcmp(argv[1], "empty") == 0 || strcmp(argv[1], "one") == 0)) {
+        return bench_child_startup(strcmp(argv[1], "one") == 0);
+    }
+
+    size_t runs = argc > 1 ? strtoul(argv[1], NULL, 10) : BENCH_DEFAULT_RUNS;
+
+    if (runs == 0 || runs > BENCH_MAX_RUNS) {
+        fprintf(stderr, "usage: %s [runs, within [1, %d]]\n", argv[0], BENCH_MAX_RUNS);
+        return EXIT_FAILURE;
+    }
+
+    bench_result_t *results = calloc(runs, sizeof *results);
+    uint64_t *empty = calloc(runs, sizeof *empty);
+    uint64_t *one = calloc(runs, sizeof *one);
+    uint64_t *scratch = calloc(runs, sizeof *scratch);
+
+    if (!results || !empty || !one || !scratch) {
+        fprintf(stderr, "%s: unable to allocate %lu runs\n", argv[0], (unsigned long)(runs));
+        return EXIT_FAILURE;
+    }
+
+    uint64_t failures = 0;
+
+    /*
+        Interleave the kinds of children, so that a change in the
+        machine's load over time affects all of them alike.
+     */
+    for (size_t r = 0; r < runs; ++r) {
+        uint64_t elapsed = 0;
+
+        if (!bench_spawn("empty", NULL, &empty[r]) || !bench_spawn("one", NULL, &one[r])
+        || !bench_spawn("probe", &results[r], &elapsed)) {
+            fprintf(stderr, "%s: unable to run %s as a child process\n", argv[0], BENCH_SELF);
+            return EXIT_FAILURE;
+        }
+
+        failures += results[r].m_failures;
+    }
+
+    for (size_t r = 0; r < runs; ++r) {
+        scratch[r] = results[r].m_first[0].m_malloc_ns + results[r].m_first[0].m_touch_ns;
+    }
+
+    bench_spread_t empty_ns = bench_distribution(empty, runs);
+    bench_spread_t one_ns = bench_distribution(one, runs);
+    bench_spread_t share_ns = bench_distribution(scratch, runs);
+
+    printf("cgcs_malloc startup: %lu runs, %llu failed allocations\n\n",
+           (unsigned long)(runs), (unsigned long long)(failures));
+
+    printf("%-34s %10s %10s %10s\n", "us", "min", "median", "spread");
+    bench_report_spread("spawn to exit, no allocation", empty_ns);
+    bench_report_spread("spawn to exit, one allocation", one_ns);
+    bench_report_spread("allocator's share, in process", share_ns);
+
+    /*
+        The difference of two spawn times is noise unless it exceeds how much
+        either varies from run to run; the in-process share is the measurement.
+     */
+    int64_t difference = (int64_t)(one_ns.m_median) - (int64_t)(empty_ns.m_median);
+    uint64_t noise = one_ns.m_spread > empty_ns.m_spread ? one_ns.m_spread : empty_ns.m_spread;
+
+    if (runs < BENCH_MIN_SPREAD_RUNS) {
+        printf("%-34s %10s (too few runs to tell from noise)\n\n", "spawn difference (medians)", "-");
+    } else if ((uint64_t)(difference < 0 ? -difference : difference) > noise) {
+        printf("%-34s %+10.1f\n\n", "spawn difference (medians)", (double)(difference) / 1000.0);
+    } else {
+        printf("%-34s %10s (below the %.1f us spread)\n\n", "spawn difference (medians)", "-",
+               (double)(noise) / 1000.0);
+    }
+
+    printf("%-22s %9s %10s %7s %10s %7s %10s %7s\n",
+           "", "", "first", "", "touch", "", "next", "");
+    printf("%-22s %9s %10s %7s %10s %7s %10s %7s\n",
+           "probe", "bytes", "ns", "faults", "ns", "faults", "ns", "faults");
+
+    for (size_t i = 0; i < BENCH_PROBE_COUNT; ++i) {
+        bench_report_probe(results, runs, i, scratch);
+    }
+
+    free(scratch);
+    free(one);
+    free(empty);
+    free(results);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,51 @@
+##
+## Generates a single-header amalgamation of the cgcs_malloc library.
+##
+## Usage:
+##   cmake -DHEADER=<cgcs_malloc.h> -DSOURCES=<a.c|b.c> -DOUTPUT=<out.h>
+##         -P cgcs_malloc_amalgamate.cmake
+##
+## The public header is copied as-is. The sources follow it, guarded by
+## `CGCS_MALLOC_IMPLEMENTATION` -- define it in exactly one translation unit
+## before `#include "cgcs_malloc_single.h"` to compile the allocator there.
+##
+## The allocator needs `mmap` flags and `madvise` advice that strict ISO C
+## (`-std=c11`) hides, so the amalgamation opens by defining `_DEFAULT_SOURCE`
+## in that translation unit -- which only takes effect if it is included
+## before any system header.
+##
+
+if(NOT HEADER OR NOT SOURCES OR NOT OUTPUT)
+    message(FATAL_ERROR "cgcs_malloc_amalgamate: HEADER, SOURCES and OUTPUT are required")
+endif()
+
+string(REPLACE "|" ";" SOURCES "${SOURCES}")
+
+get_filename_component(HEADER_NAME ${HEADER} NAME)
+file(READ ${HEADER} HEADER_TEXT)
+
+set(AMALGAMATION "/* Generated from ${HEADER_NAME} by cgcs_malloc_amalgamate.cmake -- do not edit. */\n\n")
+string(APPEND AMALGAMATION "#ifdef CGCS_MALLOC_IMPLEMENTATION\n")
+string(APPEND AMALGAMATION "#ifndef _DEFAULT_SOURCE\n")
+string(APPEND AMALGAMATION "#define _DEFAULT_SOURCE\n")
+string(APPEND AMALGAMATION "#endif\n")
+string(APPEND AMALGAMATION "#endif /* CGCS_MALLOC_IMPLEMENTATION */\n\n")
+string(APPEND AMALGAMATION "${HEADER_TEXT}\n")
+string(APPEND AMALGAMATION "#ifdef CGCS_MALLOC_IMPLEMENTATION\n")
+string(APPEND AMALGAMATION "#ifndef CGCS_MALLOC_IMPLEMENTATION_INCLUDED\n")
+string(APPEND AMALGAMATION "#define CGCS_MALLOC_IMPLEMENTATION_INCLUDED\n\n")
+
+foreach(SOURCE ${SOURCES})
+    get_filename_component(SOURCE_NAME ${SOURCE} NAME)
+    file(READ ${SOURCE} SOURCE_TEXT)
+
+    ## The public header is already part of the amalgamation.
+    string(REPLACE "#include \"${HEADER_NAME}\"" "/* #include \"${HEADER_NAME}\" */" SOURCE_TEXT "${SOURCE_TEXT}")
+
+    string(APPEND AMALGAMATION "/* ---- ${SOURCE_NAME} ---- */\n\n${SOURCE_TEXT}\n")
+endforeach()
+
+string(APPEND AMALGAMATION "#endif /* CGCS_MALLOC_IMPLEMENTATION_INCLUDED */\n")
+string(APPEND AMALGAMATION "#endif /* CGCS_MALLOC_IMPLEMENTATION */\n")
+
+file(WRITE ${OUTPUT} "${AMALGAMATION}")
@@ -0,0 +1,66 @@
+##
+## Builds cgcs_malloc with profile-guided optimization.
+##
+## Usage (from the repository root):
+##   cmake [-DBUILD_DIR=./build/make/PGO] [-DCMAKE_C_COMPILER=clang]
+##         -P ./cmake/cgcs_malloc_pgo.cmake
+##
+## 1. configures BUILD_DIR with CGCS_MALLOC_PGO=GENERATE and builds it,
+## 2. runs the `cgcs_malloc_pgo_train` target (every registered workload),
+## 3. merges raw clang profiles with llvm-profdata, if there are any,
+## 4. reconfigures the same BUILD_DIR with CGCS_MALLOC_PGO=USE and rebuilds.
+##
+## The same build directory is used for both phases, so that gcc finds
+## its .gcda files under the object paths it recorded them for.
+##
+
+get_filename_component(SOURCE_DIR "${CMAKE_CURRENT_LIST_DIR}/.." ABSOLUTE)
+
+if(NOT BUILD_DIR)
+    set(BUILD_DIR "${SOURCE_DIR}/build/make/PGO")
+endif()
+
+get_filename_component(BUILD_DIR "${BUILD_DIR}" ABSOLUTE)
+set(PROFILE_DIR "${BUILD_DIR}/pgo")
+
+set(CONFIGURE_ARGS -S "${SOURCE_DIR}" -B "${BUILD_DIR}" -DCMAKE_BUILD_TYPE=Release "-DCGCS_MALLOC_PGO_DIR=${PROFILE_DIR}")
+
+if(CMAKE_C_COMPILER)
+    list(APPEND CONFIGURE_ARGS "-DCMAKE_C_COMPILER=${CMAKE_C_COMPILER}")
+endif()
+
+function(pgo_run)
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE RESULT)
+
+    if(NOT RESULT EQUAL 0)
+        string(REPLACE ";" " " COMMAND_LINE "${ARGN}")
+        message(FATAL_ERROR "cgcs_malloc_pgo: '${COMMAND_LINE}' failed (${RESULT})")
+    endif()
+endfunction()
+
+## 1. instrumented build
+file(REMOVE_RECURSE "${PROFILE_DIR}")
+pgo_run(${CMAKE_COMMAND} ${CONFIGURE_ARGS} -DCGCS_MALLOC_PGO=GENERATE)
+pgo_run(${CMAKE_COMMAND} --build "${BUILD_DIR}" --clean-first)
+
+## 2. training run
+pgo_run(${CMAKE_COMMAND} --build "${BUILD_DIR}" --target "cgcs_malloc_pgo_train")
+
+## 3. clang writes .profraw files, which must be merged; gcc's .gcda files are used as-is
+file(GLOB RAW_PROFILES "${PROFILE_DIR}/*.profraw")
+
+if(RAW_PROFILES)
+    find_program(LLVM_PROFDATA NAMES "llvm-profdata")
+
+    if(NOT LLVM_PROFDATA)
+        message(FATAL_ERROR "cgcs_malloc_pgo: llvm-profdata is required to merge clang profiles")
+    endif()
+
+    pgo_run(${LLVM_PROFDATA} merge "-output=${PROFILE_DIR}/cgcs_malloc.profdata" ${RAW_PROFILES})
+endif()
+
+## 4. optimized build
+pgo_run(${CMAKE_COMMAND} ${CONFIGURE_ARGS} -DCGCS_MALLOC_PGO=USE)
+pgo_run(${CMAKE_COMMAND} --build "${BUILD_DIR}" --clean-first)
+
+message(STATUS "cgcs_malloc_pgo: profile-optimized build is in ${BUILD_DIR}")
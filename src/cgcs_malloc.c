@@ -6,34 +6,137 @@
     \date       12 Feb 2021
  */
 
+// `MAP_ANONYMOUS`, `MADV_DONTNEED` and `syscall` are hidden by strict ISO C (`-std=c11`).
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
 #include "cgcs_malloc.h"
 
+#include <limits.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
+#include <time.h>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/*!
+    \def        CGCS_MALLOC_RESERVE_SIZE
+    \brief      Directive for size of the virtual address range reserved for `block`
+
+    \details
+    The whole range is reserved up front, inaccessible (`PROT_NONE`),
+    so that `block` can grow in place without ever becoming discontiguous.
+    Must not exceed the largest value of `cgcs_header_size_t`.
+ */
+#define CGCS_MALLOC_RESERVE_SIZE    ((size_t)(1) << 30)
+
+/*!
+    \def        CGCS_MALLOC_COMMIT_SIZE
+    \brief      Directive for the granularity in which `block` is committed
+
+    \details
+    The first `CGCS_MALLOC_COMMIT_SIZE` bytes are made readable and writable
+    by `mem_initialize`; `mem_grow` commits further multiples of it
+    whenever no free block is large enough for a request.
+    Must be a multiple of the page size.
+ */
+#define CGCS_MALLOC_COMMIT_SIZE     ((size_t)(64) << 10)
+
+/*!
+    \def        CGCS_MALLOC_PRESSURE_READ_MS
+    \brief      How often the maintenance thread re-reads its cgroup's
+                `memory.max`, `memory.current` and `memory.pressure`
+
+    \details
+    The remaining `CGCS_MALLOC_PRESSURE_*` thresholds decide the pressure level:
+    the `some avg10` stall percentage from `memory.pressure` (PSI),
+    and the usage of the cgroup relative to `memory.max`.
+ */
+#define CGCS_MALLOC_PRESSURE_READ_MS            1000
+#define CGCS_MALLOC_PURGE_BATCH                 64          //!< free blocks claimed per `mem_lock` release by the purge
+#define CGCS_MALLOC_PRESSURE_ELEVATED_AVG10     1.0         //!< `some avg10` (%) that shortens decay
+#define CGCS_MALLOC_PRESSURE_CRITICAL_AVG10     10.0        //!< `some avg10` (%) that purges at once
+#define CGCS_MALLOC_PRESSURE_CRITICAL_USAGE     0.9         //!< `memory.current / memory.max` that purges at once
+#define CGCS_MALLOC_PRESSURE_SMALL_CGROUP       (64ULL << 20) //!< `memory.max` below which caches are halved
+
+/*!
+    \def        CGCS_MALLOC_LARGE_CLASS_COUNT
+    \brief      Directive for the number of classes of cached large mappings
+
+    \details
+    Large requests (`CGCS_MALLOC_LARGE_SIZE`, see cgcs_malloc.h) bypass `block`. Their mappings are bucketed into
+    `CGCS_MALLOC_LARGE_CLASS_COUNT` power-of-two classes, starting at
+    `CGCS_MALLOC_LARGE_SIZE`; freed mappings are kept for reuse, up to
+    `CGCS_MALLOC_LARGE_CACHE_BYTES` in total, until they decay.
+    Larger requests than the last class are mapped exactly, and never cached.
+ */
+#define CGCS_MALLOC_LARGE_CLASS_COUNT   11                  //!< classes of 1 MiB, 2 MiB, ..., 1 GiB
+#define CGCS_MALLOC_LARGE_CACHE_BYTES   ((size_t)(64) << 20) //!< most bytes of freed mappings kept for reuse
+#define CGCS_MALLOC_LARGE_OFFSET        64                  //!< offset of the client's memory within a large mapping
+#define CGCS_MALLOC_LARGE_MAGIC         ((uintptr_t)(0x6c61726765636763ULL))
+
+#define CGCS_ARENA_MAGIC            ((uintptr_t)(0x6172656e61636763ULL))    //!< marks a live `cgcs_arena_t`
+#define CGCS_POOL_MAGIC             ((uintptr_t)(0x706f6f6c63676373ULL))    //!< marks a live `cgcs_pool_t`
+
+/*!
+    \def        CGCS_STACK_CLASS_COUNT
+    \brief      Number of size classes in the stack pool
+
+    \details
+    Class `i` holds stacks of `(1 << i)` pages, guard page excluded;
+    `cgcs_stack_alloc` rounds requests up to the next class.
+ */
+#define CGCS_STACK_CLASS_COUNT      16
+#define CGCS_STACK_CACHE_CAPACITY   64  //!< freed stacks kept per class before they are unmapped
 
 /*!
-    \def        CGCS_MALLOC_BLOCK_SIZE
-    \brief      Directive for size of allocator byte array
+    \def        CGCS_PROFILE_VERSION
+    \brief      Version of the heap profile format written by `cgcs_profile_fputs`
+ */
+#define CGCS_PROFILE_VERSION        1
+#define CGCS_PROFILE_MAX_FILES      1024    //!< most snapshots the writer thread keeps, whatever their size
+#define CGCS_MALLOC_SNAPSHOT_RETRIES    8   //!< lock-free attempts of `mem_snapshot` before it takes `mem_lock`
+
+/*!
+    \def        CGCS_TCACHE_TOTAL_BYTES
+    \brief      Most bytes that the per-class limits of all threads' caches
+                may add up to
 
     \details
-    Informs the size of the array 
-    that will be used by the cgcs memory allocator functions.
+    `cgcs_tcache_grow` refuses to raise a limit past this budget, so that
+    many threads cannot each grow a full cache.
  */
-#define CGCS_MALLOC_BLOCK_SIZE  4096
+#define CGCS_TCACHE_TOTAL_BYTES     ((size_t)(1) << 20)
 
 /*!
     \typedef    mem_t
-    \brief      Alias for `char[CGCS_MALLOC_BLOCK_SIZE]`
+    \brief      Alias for `(struct mem)`
 
     \details
-    All instances of `char[CGCS_MALLOC_BLOCK_SIZE]` will be addressed as `mem_t`.
-    `mem_t` represents the memory source for the cgcs memory allocator functions.
+    `mem_t` represents the memory source for the cgcs memory allocator functions:
+    a range of up to `CGCS_MALLOC_RESERVE_SIZE` bytes reserved from `m_provider`,
+    of which the first `m_committed` bytes are usable.
 
-    \see    CGCS_MALLOC_BLOCK_SIZE
+    \see    CGCS_MALLOC_RESERVE_SIZE
+    \see    CGCS_MALLOC_COMMIT_SIZE
  */
-typedef char mem_t[CGCS_MALLOC_BLOCK_SIZE];
+typedef struct mem {
+    char *m_base;       //! base address of the reservation; `NULL` until `mem_initialize`
+    size_t m_reserved;  //! bytes reserved from `m_base`
+    size_t m_committed; //! bytes committed (readable/writable) from `m_base`
+
+    cgcs_page_provider_t m_provider;    //! where the reservation and large mappings come from
+} mem_t;
 
 /*!
     \typedef    header_t
@@ -44,16 +147,204 @@ typedef char mem_t[CGCS_MALLOC_BLOCK_SIZE];
  */
 typedef struct header header_t;
 
+static void *page_mmap_reserve(const cgcs_page_provider_t *self, size_t *length);
+static bool page_mmap_commit(const cgcs_page_provider_t *self, void *address, size_t length);
+static void page_mmap_purge(const cgcs_page_provider_t *self, void *address, size_t length);
+static void page_mmap_release(const cgcs_page_provider_t *self, void *address, size_t length);
+static void *page_mmap_map(const cgcs_page_provider_t *self, size_t length);
+
+/*
+    Operations of the default page provider -- anonymous private mappings
+ */
+#define PAGE_PROVIDER_MMAP {                                                   \
+    .m_name = "mmap", .m_reserve = page_mmap_reserve, .m_commit = page_mmap_commit, \
+    .m_purge = page_mmap_purge, .m_release = page_mmap_release,                \
+    .m_map = page_mmap_map, .m_unmap = page_mmap_release, .m_fd = -1           \
+}
+
+/*
+    Global instance of the allocator's memory source
+ */
+static mem_t block = { .m_provider = PAGE_PROVIDER_MMAP };
+
+/*!
+    \struct     cgcs_arena
+    \brief      A heap within a buffer owned by the caller, see `cgcs_arena_create_in`
+
+    \details
+    Stored at the start of the buffer; `m_mem` manages the rest of it,
+    through a static page provider.
+ */
+struct cgcs_arena {
+    uintptr_t m_magic;          //! `self ^ CGCS_ARENA_MAGIC` while the arena is alive
+    pthread_mutex_t m_lock;     //! guards the headers of `m_mem`
+    mem_t m_mem;
+};
+
+/*!
+    \typedef    pool_slot_t
+    \brief      A free slot of a `cgcs_pool_t`, linked through its own storage
+ */
+typedef struct pool_slot {
+    struct pool_slot *m_next;
+} pool_slot_t;
+
+/*!
+    \struct     cgcs_pool
+    \brief      Fixed-size slots carved from one allocation, see `cgcs_pool_create`
+
+    \details
+    Stored at the start of that allocation, followed by the slots
+    and by a bitmap with one bit per slot, set while the slot is allocated.
+ */
+struct cgcs_pool {
+    uintptr_t m_magic;          //! `self ^ CGCS_POOL_MAGIC` while the pool is alive
+    pthread_mutex_t m_lock;     //! guards `m_free`, `m_used` and `m_in_use`
+    pool_slot_t *m_free;        //! free slots, lowest address first
+    char *m_slots;              //! first slot
+    size_t m_slot_size;         //! bytes per slot, a multiple of `sizeof(pool_slot_t)`
+    size_t m_count;             //! number of slots
+    size_t m_used;              //! number of slots allocated
+    unsigned char *m_in_use;    //! one bit per slot
+    void *m_region;             //! the allocation holding all of the above
+};
+
+/*
+    Guards `block` -- held by `cgcs_malloc_impl`, `cgcs_free_impl`
+    and the maintenance thread while they read or modify headers.
+    Taken and released with `mem_lock_acquire` and `mem_lock_release`.
+ */
+static pthread_mutex_t mem_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+    Sequence count of `block`: odd while `mem_lock` is held, so that
+    `mem_snapshot` can walk the headers without taking the lock,
+    and tell whether anything changed while it did.
+ */
+static atomic_uint mem_sequence;
+
+/*
+    State of the optional background maintenance thread.
+    Every field other than `m_thread` is guarded by `mem_lock`.
+ */
+static struct {
+    pthread_t m_thread;
+    pthread_cond_t m_wakeup;
+
+    bool m_running;             //! `true` between `cgcs_maintenance_start` and `cgcs_maintenance_stop`
+    bool m_coalesce_pending;    //! a free deferred its `header_coalesce` pass to the thread
+    bool m_dirty;               //! freed pages have not been purged yet
+
+    unsigned m_interval_ms;     //! time between maintenance ticks
+    unsigned m_decay_ms;        //! how long freed pages stay dirty before they are purged
+
+    struct timespec m_dirty_since;
+} maintenance = { .m_wakeup = PTHREAD_COND_INITIALIZER };
+
+/*!
+    \typedef    large_header_t
+    \brief      Alias for `(struct large_header)`
+
+    \details
+    Bookkeeping at the start of every large mapping. The client's memory
+    starts `CGCS_MALLOC_LARGE_OFFSET` bytes in, right after a `header_t`
+    whose `m_size` marks the allocation as large and in use, so that
+    `cgcs_tcache_push` leaves it alone.
+ */
+typedef struct large_header {
+    uintptr_t m_magic;              //! `self ^ CGCS_MALLOC_LARGE_MAGIC` while in use, `~` of that while cached
+    size_t m_length;                //! length of the whole mapping
+    size_t m_class;                 //! class index; `CGCS_MALLOC_LARGE_CLASS_COUNT` if never cached
+    struct large_header *m_next;    //! next cached mapping of the same class
+    struct timespec m_freed_at;     //! when the mapping entered the cache
+} large_header_t;
+
+
+/*
+    Large mappings freed by `cgcs_free_impl`, waiting for reuse, by class.
+    Guarded by `large_lock`, which may be taken while `mem_lock` is held.
+ */
+static struct {
+    large_header_t *m_free[CGCS_MALLOC_LARGE_CLASS_COUNT];
+    size_t m_bytes;                 //! total length of every cached mapping
+    bool m_mapped;                  //! a mapping has been made; the page provider is fixed
+} large_cache;
+
+static pthread_mutex_t large_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+    Number and total length of the mappings of live large allocations,
+    for `cgcs_heap_summary` and `cgcs_profile_fputs`
+ */
+static atomic_size_t large_live_count;
+static atomic_size_t large_live_bytes;
+
+/*!
+    \typedef    stack_node_t
+    \brief      Alias for `(struct stack_node)`
+
+    \details
+    A cached stack links to the next one of its class through
+    a `stack_node_t` stored at its lowest usable address.
+ */
+typedef struct stack_node {
+    struct stack_node *m_next;
+} stack_node_t;
+
+/*
+    Stacks freed by `cgcs_stack_free`, waiting for reuse, by size class.
+    Guarded by `stack_lock`, which may be taken while `mem_lock` is held.
+ */
+static struct {
+    stack_node_t *m_free[CGCS_STACK_CLASS_COUNT];
+    size_t m_count[CGCS_STACK_CLASS_COUNT];
+} stack_pool;
+
+static pthread_mutex_t stack_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*!
+    \enum       mem_pressure_level
+    \brief      How hard the maintenance thread gives memory back
+ */
+enum mem_pressure_level {
+    MEM_PRESSURE_NORMAL,    //!< configured decay, full thread caches
+    MEM_PRESSURE_ELEVATED,  //!< decay and interval cut to a quarter, caches cut to a quarter
+    MEM_PRESSURE_CRITICAL   //!< purge on every pass, no caching
+};
+
 /*
-    Global instance of byte array, in .BSS section of memory
+    Memory limit and pressure of the process' cgroup (v2),
+    as last read by `pressure_update`. Only the maintenance thread
+    writes it; `m_level` is read under `mem_lock`.
+
+    The cgroup directory is taken from `CGCS_MALLOC_CGROUP_DIR` if it is set
+    (e.g. a fake directory, for testing), otherwise from `/proc/self/cgroup`.
  */
-static mem_t block;
+static struct {
+    char m_dir[256];                    //! cgroup directory; empty if there is none
+    bool m_resolved;                    //! `m_dir` has been looked up
+
+    struct timespec m_last_read;
 
-static void mem_initialize();
-static void *mem_first_byte_address();
-static void *mem_last_byte_address();
-static header_t *mem_first_header_alignment();
-static header_t *mem_last_possible_header_alignment();
+    unsigned long long m_max;           //! `memory.max`, in bytes; 0 if unlimited or unknown
+    unsigned long long m_current;       //! `memory.current`, in bytes
+    double m_some_avg10;                //! `some avg10` from `memory.pressure`, in percent
+
+    enum mem_pressure_level m_level;
+} pressure = { .m_level = MEM_PRESSURE_NORMAL };
+
+static void mem_sequence_begin();
+static void mem_sequence_end();
+static void mem_lock_acquire();
+static void mem_lock_release();
+
+static bool mem_initialize(mem_t *self);
+static bool mem_is_initialized(const mem_t *self);
+static header_t *mem_grow(mem_t *self, header_t *last, size_t size);
+static void *mem_first_byte_address(const mem_t *self);
+static void *mem_last_byte_address(const mem_t *self);
+static header_t *mem_first_header_alignment(const mem_t *self);
+static header_t *mem_last_possible_header_alignment(const mem_t *self);
 
 /*!
     \typedef    header_t
@@ -61,549 +352,3509 @@ static header_t *mem_last_possible_header_alignment();
 
     \details
     All instances of `(struct header)` will be addressed as `header_t.`
+
+    The header is padded to `CGCS_MALLOC_ALIGNMENT` bytes, and every block
+    size is a multiple of it, so that every allocation after a header
+    is aligned for any type. `m_size` comes last, right before the allocation.
  */
 struct header {
-    int16_t m_size; //! size of allocation after `header_t`, negative value means allocation is in use
+    _Alignas(max_align_t) char m_padding[CGCS_MALLOC_ALIGNMENT - sizeof(cgcs_header_size_t)];
+    cgcs_header_size_t m_size; //! size of allocation after `header_t`, negative value means allocation is in use
 }; 
 
+_Static_assert(sizeof(header_t) == CGCS_MALLOC_ALIGNMENT,
+               "block sizes are rounded to `sizeof(header_t)`, which must be the alignment of every allocation");
+_Static_assert(offsetof(header_t, m_size) == sizeof(header_t) - sizeof(cgcs_header_size_t),
+               "cgcs_tcache_push reads the `cgcs_header_size_t` right before an allocation");
+_Static_assert(sizeof(large_header_t) + sizeof(header_t) <= CGCS_MALLOC_LARGE_OFFSET,
+               "`large_header_t` must fit before a large allocation's header");
+_Static_assert(CGCS_MALLOC_RESERVE_SIZE <= INT32_MAX,
+               "the size of any block must fit in `cgcs_header_size_t`");
+
+/*
+    Per-thread cache of small blocks, see `cgcs_tcache_push` and `cgcs_tcache_pop`
+ */
+_Thread_local cgcs_tcache_t cgcs_tcache;
+
+/*
+    Per-class capacity of every thread's cache, see `pressure_update`
+ */
+atomic_uint_least8_t cgcs_tcache_limit = CGCS_TCACHE_CLASS_CAPACITY;
+
+/*
+    Flush epoch of every thread's cache, see `pressure_update` and `cgcs_tcache_drain`
+ */
+atomic_uint cgcs_tcache_epoch;
+
+/*
+    Coarse clock of every thread's cache, see `tcache_reclaim_idle`
+ */
+atomic_uint cgcs_tcache_clock;
+
+/*
+    Bytes accounted for by the per-class limits of every thread's cache,
+    at most `CGCS_TCACHE_TOTAL_BYTES`; only changes when a limit does.
+ */
+static atomic_size_t tcache_budget;
+
+/*
+    Every cache that has been given capacity, until its thread exits --
+    guarded by `m_lock`, walked by the maintenance thread.
+ */
+static struct {
+    pthread_mutex_t m_lock;
+    cgcs_tcache_t *m_caches;
+    int m_barrier;          //! `membarrier` command that reaches every thread; 0 if none, -1 until known
+} tcache_registry = { PTHREAD_MUTEX_INITIALIZER, NULL, -1 };
+
+/*
+    Per-thread allocation counters, see `cgcs_stats_count_malloc` and `cgcs_stats_count_free`
+ */
+_Thread_local cgcs_stats_slot_t cgcs_stats_slot;
+
+/*
+    Registry of every live thread's `cgcs_stats_slot`, and the sums
+    of the slots of threads that have exited -- guarded by `m_lock`.
+ */
+static struct {
+    pthread_mutex_t m_lock;
+    cgcs_stats_slot_t *m_slots;
+    cgcs_stats_t m_retired;
+    pthread_key_t m_key;    //! destructor retires a thread's slot
+    pthread_once_t m_key_once;
+} stats_registry = { PTHREAD_MUTEX_INITIALIZER, NULL, { 0 }, 0, PTHREAD_ONCE_INIT };
+
+static void stats_key_create();
+static void stats_accumulate(cgcs_stats_t *stats, cgcs_stats_slot_t *slot);
+static void stats_retire(void *arg);
+
+/*
+    State of the optional heap profile writer thread -- guarded by `m_lock`,
+    except for `m_thread`.
+ */
+static struct {
+    pthread_t m_thread;
+    pthread_mutex_t m_lock;
+    pthread_cond_t m_wakeup;
+
+    bool m_running;             //! `true` between `cgcs_profile_start` and `cgcs_profile_stop`
+    unsigned m_interval_s;      //! time between snapshots
+    size_t m_max_bytes;         //! most bytes of snapshots kept in `m_dir`
+    char m_dir[256];            //! directory the snapshots are written to
+
+    unsigned long m_next;       //! sequence number of the next snapshot
+    unsigned long m_oldest;     //! sequence number of the oldest snapshot on disk
+    size_t m_bytes;             //! bytes of the snapshots on disk
+    size_t m_sizes[CGCS_PROFILE_MAX_FILES]; //! size of snapshot `n`, at `n % CGCS_PROFILE_MAX_FILES`
+} profile = { .m_lock = PTHREAD_MUTEX_INITIALIZER, .m_wakeup = PTHREAD_COND_INITIALIZER };
+
+static void *profile_run(void *arg);
+static void profile_snapshot();
+static void profile_path(char *path, size_t length, unsigned long n);
+
+/*
+    Key whose destructor flushes a thread's `cgcs_tcache` when the thread exits
+ */
+static pthread_key_t tcache_key;
+static pthread_once_t tcache_key_once = PTHREAD_ONCE_INIT;
+
+static void tcache_key_create();
+static void tcache_destroy(void *arg);
+static void tcache_release_budget(size_t bytes);
+static void tcache_reclaim_idle(unsigned idle_ms);
+static bool tcache_barrier();
+static void tcache_flush(cgcs_tcache_t *cache);
+
 static header_t *header_next(header_t *self);
-static int16_t header_alloc_size(header_t *self);
+static void header_store_size(header_t *self, cgcs_header_size_t size);
+static cgcs_header_size_t header_alloc_size(header_t *self);
 
 static bool header_is_free(header_t *self);
 static bool header_is_used(header_t *self);
-static bool header_is_last(header_t *self);
+static bool header_is_last(header_t *self, const mem_t *mem);
 
-static int16_t header_calculate_split_remainder_size(header_t *self, int16_t size_to_keep);
+static cgcs_header_size_t header_calculate_split_remainder_size(header_t *self, cgcs_header_size_t size_to_keep);
 
 static void header_toggle_use_status(header_t *self);
 //static bool header_is_corrupt(header_t *self);
 
-static void header_split_block(header_t *self, size_t size);
+static void header_split_block(header_t *self, const mem_t *mem, size_t size);
 static void header_merge_with_next_block(header_t *self);
-static void header_coalesce(header_t *self);
+static void header_coalesce(header_t *self, const mem_t *mem);
 
-static bool pointer_outside_block_range(void *ptr);
+static bool pointer_outside_block_range(const mem_t *mem, void *ptr);
 
-/*!
-    \brief      Initializes block by assigning it its first header "node"
-                with its starting value(s).
+static void *large_alloc(size_t size);
+static large_header_t *large_header_of(void *ptr);
+static void large_free(large_header_t *self);
+static void large_cache_decay(unsigned decay_ms, bool release_all);
 
-    \details
-    A newly initialized block will have one header/node,
-    with its allocated capacity:
-        `(CGCS_MALLOC_BLOCK_SIZE - sizeof(header_t))`.
+static header_t *mem_take(mem_t *self, size_t size);
+static size_t mem_release(void *ptr);
+static size_t mem_snapshot_walk(cgcs_heap_summary_t *summary, cgcs_header_size_t *sizes, size_t capacity);
+static size_t mem_snapshot(cgcs_heap_summary_t *summary, cgcs_header_size_t *sizes, size_t capacity);
+static cgcs_header_size_t *mem_snapshot_map(size_t *capacity, size_t *length);
+static void mem_purge_free_pages();
 
-        The amount of usable bytes is the
-            total size of `block` - size of the first header
- */
-static inline void mem_initialize() {
-    ((header_t *)(block))->m_size = (CGCS_MALLOC_BLOCK_SIZE - sizeof(header_t));
-}
+static size_t stack_class_index(size_t size, size_t page_size);
+static void stack_pool_release();
 
-/*
-    \brief    Return the base address of the allocation block 
-              used by the memory allocator functions.
+static void pressure_resolve_dir();
+static bool pressure_read_value(const char *file, unsigned long long *value);
+static void pressure_update();
 
-    \return   Address of `block[0]`, as `(void *)`
-*/
-static inline void *mem_first_byte_address() {
-    return ((void *)(block));
-}
+static void *maintenance_run(void *arg);
+static void maintenance_tick();
+static unsigned maintenance_decay_ms();
+static void maintenance_mark_dirty();
 
 /*!
-    \brief      Return the address of the last byte
-                within the allocation block used 
-                by the memory allocation functions.
+    \brief      Marks the start of a change to `block` -- `mem_sequence` becomes odd.
 
-    \return     Address of `block[size - 1]`, as `(void *)` 
+    Precondition: `mem_lock` is held
  */
-static inline void *mem_last_byte_address() {
-    return ((void *)(block + CGCS_MALLOC_BLOCK_SIZE - 1));
+static inline void mem_sequence_begin() {
+    atomic_store_explicit(&mem_sequence, atomic_load_explicit(&mem_sequence, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
 }
 
 /*!
-    \brief      Return the base address of the allocation block
-                used by the memory allocator functions, as `(header_t *)`
+    \brief      Marks the end of a change to `block` -- `mem_sequence` becomes even.
 
-    \return     Address of `block[0]`, as `(header_t *)`
+    Precondition: `mem_lock` is held
  */
-static inline header_t *mem_first_header_alignment() {
-    return ((header_t *)(block));
+static inline void mem_sequence_end() {
+    atomic_store_explicit(&mem_sequence, atomic_load_explicit(&mem_sequence, memory_order_relaxed) + 1,
+                          memory_order_release);
 }
 
 /*!
-    \brief      Return the address of the last `sizeof(header_t)`
-                byte alignment within the allocation block used
-                by the memory allocation functions.
-
-    \details    The address of the last `sizeof(header_t)` byte chunk 
-                within [block, block + size) is returned 
-    
-    \return     Address of `block[size - sizeof(header_t)]`, as `(header_t *)`
+    \brief      Takes `mem_lock`, and opens a `mem_sequence` write section.
  */
-static inline header_t *mem_last_possible_header_alignment() {
-    return ((header_t *)(block + (CGCS_MALLOC_BLOCK_SIZE - sizeof(header_t))));
+static inline void mem_lock_acquire() {
+    pthread_mutex_lock(&mem_lock);
+    mem_sequence_begin();
 }
 
 /*!
-    \brief      Return the next header; the header to the "right" of `self`.      
-
-    \details    Advance `(sizeof(header_t) + header_alloc_size(self))` bytes from `self`.
-
-    \param[in]  self    The current `header_t`
-    
-    \return     The address that is `sizeof(header_t)` + `header_alloc_size(self)` away
-                from `self`.
+    \brief      Closes the `mem_sequence` write section, and releases `mem_lock`.
  */
-static inline header_t *header_next(header_t *self) {
-    return ((header_t *)((char *)(self) + sizeof *self + header_alloc_size(self)));
+static inline void mem_lock_release() {
+    mem_sequence_end();
+    pthread_mutex_unlock(&mem_lock);
 }
 
 /*!
-    \brief      Return the absolute value of `self->m_size`.
-
-    \details    A negative value denotes that the block assigned to `self`
-                is in use. A positive value denotes a free block.
+    \brief      Reserves `*length` bytes of address space, inaccessible until committed.
 
-    \param[in]  self    The current `header_t`
-    
-    \return     `abs(self->m_size)`
+    \details    `MAP_NORESERVE`: nothing is charged against swap or overcommit
+                until `page_mmap_commit` makes the pages accessible.
  */
-static inline int16_t header_alloc_size(header_t *self) {
-    return abs(self->m_size);
+static void *page_mmap_reserve(const cgcs_page_provider_t *self, size_t *length) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#ifdef MAP_NORESERVE
+    flags |= MAP_NORESERVE;
+#endif /* MAP_NORESERVE */
+
+    void *base = mmap(NULL, *length, PROT_NONE, flags, self->m_fd, 0);
+    return base == MAP_FAILED ? NULL : base;
 }
 
 /*!
-    \brief      Determine if the block addressed at `(self + 1)` is not in use.
-
-    \param[in]  self    The current `header_t`
-    
-    \return     `true`, if `self->m_size >= 0`, `false` otherwise.
+    \brief      Makes reserved pages readable and writable; they are faulted in on first touch.
  */
-static inline bool header_is_free(header_t *self) {
-    return self->m_size >= 0;
+static bool page_mmap_commit(const cgcs_page_provider_t *self, void *address, size_t length) {
+    (void)(self);
+    return mprotect(address, length, PROT_READ | PROT_WRITE) == 0;
 }
 
 /*!
-    \brief      Determine if the block addressed at `(self + 1)` is in use.
-
-    \param[in]  self    The current `header_t`
-    
-    \return     `true`, if `self->m_size < 0`, `false` otherwise.
+    \brief      Drops the contents of committed pages; they read as zero on next touch.
  */
-static inline bool header_is_used(header_t *self) {
-    return self->m_size < 0;
+static void page_mmap_purge(const cgcs_page_provider_t *self, void *address, size_t length) {
+    (void)(self);
+    madvise(address, length, MADV_DONTNEED);
 }
 
 /*!
-    \brief      Determine if `self` is the last header within block.
-
-    \details    Invoking `header_next(self)`, if `self` is the last header,
-                should yield the address of the first byte outside of
-                `block`. 
-                
-                Therefore, `header_next(self) - 1` should yield
-                the address of the last `sizeof(header_t)` byte alignment
-                within block.
-
-                If `header_next(self) - 1` is the same address as that of
-                `mem_last_possible_header_alignment()`, `self` is the address
-                of the last `header_t` within block.
-
-    \param[in]  self    The current `header_t`
-    
-    \return     `true`, if `self` is the last header in `block`, `false` otherwise.
+    \brief      Unmaps a reservation, or a mapping made by `page_mmap_map`.
  */
-static inline bool header_is_last(header_t *self) {
-    return header_next(self) - 1 == mem_last_possible_header_alignment();
+static void page_mmap_release(const cgcs_page_provider_t *self, void *address, size_t length) {
+    (void)(self);
+    munmap(address, length);
 }
 
 /*!
-    \brief      Determine the excess byte count if `self->m_size` was reduced
-                to `size_to_keep`.
+    \brief      Maps `length` readable and writable bytes of anonymous memory.
+ */
+static void *page_mmap_map(const cgcs_page_provider_t *self, size_t length) {
+    (void)(self);
 
-    \details    This function is used to determine if `self->m_size`
-                can be reduced to `size_to_keep` 
-                such that the portion split away from `self->m_size`
-                (aka the remainder size) is greater than or equal to 1 byte.
+    void *address = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return address == MAP_FAILED ? NULL : address;
+}
 
-    \param[in]  self            The current `header_t`
-    \param[in]  size_to_keep    The desired size for `self->m_size`
-    
-    \return     `self->m_size - size_to_keep - sizeof(header_t)`
+/*!
+    \brief      Hands out the caller's buffer, aligned up to `max_align_t`,
+                as the whole reservation.
  */
-static inline int16_t header_calculate_split_remainder_size(header_t *self, int16_t size_to_keep) {
-    return ((int16_t)(self->m_size - size_to_keep - sizeof *self));
+static void *page_static_reserve(const cgcs_page_provider_t *self, size_t *length) {
+    uintptr_t begin = (uintptr_t)(self->m_buffer);
+    uintptr_t aligned = (begin + _Alignof(max_align_t) - 1) & ~(uintptr_t)(_Alignof(max_align_t) - 1);
+
+    if (aligned - begin >= self->m_length) {
+        return NULL;
+    }
+
+    size_t available = self->m_length - (size_t)(aligned - begin);
+    *length = available < *length ? available : *length;
+
+    return (void *)(aligned);
 }
 
 /*!
-    \brief  Coalesces memory referred to by `self` and `self->next`
-            into one block.
-  
-    \param[in]  self    The current `header_t`
-  
-    Precondition: `header_free(self) && header_free(header_next(self))`
- 
-    This function is called by `cgcs_malloc_impl` or `cgcs_free_impl`, when the precondition
-    above is fulfilled. It is not to be called unless conditions for
-    coalescence are clearly defined.
+    \brief      Commits nothing: the caller's buffer is already accessible.
  */
-static inline void header_merge_with_next_block(header_t *self) {
-    header_t *next = header_next(self);
-    self->m_size += next->m_size + sizeof *next;
+static bool page_static_commit(const cgcs_page_provider_t *self, void *address, size_t length) {
+    (void)(self);
+    (void)(address);
+    (void)(length);
+    return true;
 }
 
 /*!
-    \brief      Mark the block assigned to self as in use, if it is free --
-                otherwise, mark it as free, if it is in use.
-    
-    \details    Used for assigning/reclaiming a block.
-                The two's complement of `self->m_size` is assigned to itself,
-                which effectively amounts to a multiplication by (-1). 
-    
-    \param[in]  self    The current `header_t`
+    \brief      Returns the huge page size from `/proc/meminfo`, in bytes; 0 if there is none.
  */
-static inline void header_toggle_use_status(header_t *self) {
-    self->m_size = (~self->m_size) + 1;
+static size_t page_huge_size() {
+    FILE *f = fopen("/proc/meminfo", "r");
+    char line[128];
+    unsigned long kib = 0;
+
+    while (f && fgets(line, sizeof line, f)) {
+        if (sscanf(line, "Hugepagesize: %lu kB", &kib) == 1) {
+            break;
+        }
+    }
+
+    if (f) {
+        fclose(f);
+    }
+
+    return (size_t)(kib) * 1024;
 }
 
 /*!
-    \brief      Can be used to check if header has an invalid `m_size` value.
+    \brief      Maps and unmaps one huge page of `huge` bytes.
 
-    \details
-    Under normal use, a `header_t` should never have an `m_size` value of 0,
-    nor should it exceed a value of CGCS_MALLOC_BLOCK_SIZE - sizeof(header_t).
+    \details    `Hugepagesize` is reported even when the pool is empty, and then
+                every commit would fail. A `MAP_HUGETLB` mapping takes its pages
+                from the pool (or the overcommit allowance) when it is made,
+                so one that succeeds proves that the pool can serve at least a page.
 
-    This would only occur if an `header_t`'s `m_size` field was modified directly.
+    \return     `true` if the page could be mapped, `false` otherwise.
+ */
+static bool page_huge_probe(size_t huge) {
+#ifdef MAP_HUGETLB
+    void *page = mmap(NULL, huge, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
 
-    \param[in]  self    The current `header_t`
+    if (page == MAP_FAILED) {
+        return false;
+    }
 
-    \return     `true`, if `self->m_size == 0 || self->m_size > CGCS_MALLOC_BLOCK_SIZE - sizeof(header_t)`
-                false otherwise.
- */
-/*
-// UNUSED
-static inline bool header_is_corrupt(header_t *self) {
-    return self->m_size == 0 || self->m_size > CGCS_MALLOC_BLOCK_SIZE - sizeof *self;
+    munmap(page, huge);
+    return true;
+#else
+    (void)(huge);
+    return false;
+#endif /* MAP_HUGETLB */
 }
-*/
 
 /*!
-    \brief      Determines if `ptr`'s address is less than the first address at block,
-                or if `ptr`'s address is greater than the last address at block.
+    \brief      Reserves `*length` bytes, rounded down to huge pages,
+                at an address aligned to a huge page.
 
-    \param[in]  ptr     The pointer to assess
+    \details    The reservation itself is made of ordinary inaccessible pages;
+                `page_huge_commit` maps huge pages over it.
+ */
+static void *page_huge_reserve(const cgcs_page_provider_t *self, size_t *length) {
+    size_t huge = self->m_length;
+    size_t reserved = *length / huge * huge;
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#ifdef MAP_NORESERVE
+    flags |= MAP_NORESERVE;
+#endif /* MAP_NORESERVE */
+
+    if (reserved == 0) {
+        return NULL;
+    }
+
+    char *base = mmap(NULL, reserved + huge, PROT_NONE, flags, -1, 0);
+
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+
+    char *aligned = (char *)(((uintptr_t)(base) + huge - 1) & ~(uintptr_t)(huge - 1));
+
+    if (aligned > base) {
+        munmap(base, (size_t)(aligned - base));
+    }
+
+    munmap(aligned + reserved, (size_t)(base + huge - aligned));
+
+    *length = reserved;
+    return aligned;
+}
+
+/*!
+    \brief      Maps huge pages over the part of [`address`, `address + length`)
+                that earlier commits did not already cover.
+
+    \details    Commits come front to back, each starting where the last ended;
+                a previous commit was rounded up to a whole huge page, so this one
+                starts at the next huge page boundary. Huge pages are taken from
+                the pool when they are mapped: an empty pool fails the commit,
+                instead of the first touch.
+ */
+static bool page_huge_commit(const cgcs_page_provider_t *self, void *address, size_t length) {
+#ifdef MAP_HUGETLB
+    uintptr_t huge = (uintptr_t)(self->m_length);
+    uintptr_t begin = ((uintptr_t)(address) + huge - 1) & ~(huge - 1);
+    uintptr_t end = ((uintptr_t)(address) + length + huge - 1) & ~(huge - 1);
+
+    if (begin >= end) {
+        return true;
+    }
+
+    void *mapped = mmap((void *)(begin), end - begin, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_FIXED, -1, 0);
+
+    return mapped != MAP_FAILED;
+#else
+    (void)(self);
+    (void)(address);
+    (void)(length);
+    return false;
+#endif /* MAP_HUGETLB */
+}
+
+/*!
+    \brief      Drops the contents of the whole huge pages within [`address`, `address + length`).
+ */
+static void page_huge_purge(const cgcs_page_provider_t *self, void *address, size_t length) {
+    uintptr_t huge = (uintptr_t)(self->m_length);
+    uintptr_t begin = ((uintptr_t)(address) + huge - 1) & ~(huge - 1);
+    uintptr_t end = ((uintptr_t)(address) + length) & ~(huge - 1);
+
+    if (begin < end) {
+        madvise((void *)(begin), end - begin, MADV_DONTNEED);
+    }
+}
+
+/*!
+    \brief      Unmaps a reservation or mapping, rounded up to whole huge pages.
+ */
+static void page_huge_release(const cgcs_page_provider_t *self, void *address, size_t length) {
+    size_t huge = self->m_length;
+    munmap(address, (length + huge - 1) / huge * huge);
+}
+
+/*!
+    \brief      Maps `length` bytes, rounded up to whole huge pages, for a large request.
+ */
+static void *page_huge_map(const cgcs_page_provider_t *self, size_t length) {
+#ifdef MAP_HUGETLB
+    size_t huge = self->m_length;
+    void *address = mmap(NULL, (length + huge - 1) / huge * huge, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+    return address == MAP_FAILED ? NULL : address;
+#else
+    (void)(self);
+    (void)(length);
+    return NULL;
+#endif /* MAP_HUGETLB */
+}
+
+/*!
+    \brief      Extends the backing file to `*length` bytes if it is shorter,
+                and maps it, shared and inaccessible until committed.
+ */
+static void *page_fd_reserve(const cgcs_page_provider_t *self, size_t *length) {
+    struct stat st;
+
+    if (fstat(self->m_fd, &st) != 0
+    || ((size_t)(st.st_size) < *length && ftruncate(self->m_fd, (off_t)(*length)) != 0)) {
+        return NULL;
+    }
+
+    void *base = mmap(NULL, *length, PROT_NONE, MAP_SHARED, self->m_fd, 0);
+    return base == MAP_FAILED ? NULL : base;
+}
+
+/*!
+    \brief      Gives the backing file's blocks under committed pages back;
+                they read as zero on next touch.
+ */
+static void page_fd_purge(const cgcs_page_provider_t *self, void *address, size_t length) {
+    (void)(self);
+
+#ifdef MADV_REMOVE
+    madvise(address, length, MADV_REMOVE);
+#else
+    (void)(address);
+    (void)(length);
+#endif /* MADV_REMOVE */
+}
+
+/*!
+    \brief      Fills `provider` with the default page provider:
+                anonymous private mappings, large requests mapped on their own.
+
+    \param[out] provider    Receives the provider
+ */
+void cgcs_page_provider_mmap(cgcs_page_provider_t *provider) {
+    *provider = (cgcs_page_provider_t)PAGE_PROVIDER_MMAP;
+}
+
+/*!
+    \brief      Fills `provider` with a provider that hands out `buffer`,
+                and nothing else -- like a `static` array, with no system calls.
+
+    \details    The heap can grow no further than `buffer`; large requests are
+                served from it as well. The buffer must outlive every allocation.
+
+    \param[out] provider    Receives the provider
+    \param[in]  buffer      Memory owned by the caller, readable and writable
+    \param[in]  length      Length of `buffer`, in bytes
+
+    \return     `true` on success, `false` if `buffer` is `NULL` or too short.
+ */
+bool cgcs_page_provider_static(cgcs_page_provider_t *provider, void *buffer, size_t length) {
+    if (!buffer || length < _Alignof(max_align_t) + 2 * sizeof(header_t)) {
+        fprintf(stderr, "[ERROR: cgcs_page_provider_static] A static buffer must be at least %lu bytes long.\n",
+                (unsigned long)(_Alignof(max_align_t) + 2 * sizeof(header_t)));
+        return false;
+    }
+
+    *provider = (cgcs_page_provider_t){
+        .m_name = "static", .m_reserve = page_static_reserve, .m_commit = page_static_commit,
+        .m_buffer = buffer, .m_length = length, .m_fd = -1
+    };
+
+    return true;
+}
+
+/*!
+    \brief      Fills `provider` with a provider of huge pages (`MAP_HUGETLB`)
+                from the hugetlbfs pool, for the heap and for large requests.
+
+    \details    The pool must hold enough pages (`vm.nr_hugepages`);
+                a commit or large request fails, rather than faults, when it runs out.
+                One huge page is mapped up front, so that an empty pool is refused
+                here rather than by every later `malloc`.
+
+    \param[out] provider    Receives the provider
+
+    \return     `true` on success, `false` if the system has no huge pages
+                or its pool cannot serve one.
+ */
+bool cgcs_page_provider_hugetlb(cgcs_page_provider_t *provider) {
+#ifdef MAP_HUGETLB
+    size_t huge = page_huge_size();
+
+    if (huge != 0 && (huge & (huge - 1)) == 0 && page_huge_probe(huge)) {
+        *provider = (cgcs_page_provider_t){
+            .m_name = "hugetlb", .m_reserve = page_huge_reserve, .m_commit = page_huge_commit,
+            .m_purge = page_huge_purge, .m_release = page_huge_release,
+            .m_map = page_huge_map, .m_unmap = page_huge_release, .m_length = huge, .m_fd = -1
+        };
+
+        return true;
+    }
+#endif /* MAP_HUGETLB */
+
+    fprintf(stderr, "[ERROR: cgcs_page_provider_hugetlb] Huge pages are not available.\n");
+    return false;
+}
+
+/*!
+    \brief      Fills `provider` with a provider backed by an anonymous
+                memory file (`memfd_create`), shared with any process it is passed to.
+
+    \details    Large requests are served from the file as well, so that
+                the whole heap lives in it.
+
+    \param[out] provider    Receives the provider
+    \param[in]  name        Name of the file, as shown in `/proc/self/fd`
+
+    \return     `true` on success, `false` if the file could not be created.
+ */
+bool cgcs_page_provider_memfd(cgcs_page_provider_t *provider, const char *name) {
+    int fd = -1;
+
+#ifdef SYS_memfd_create
+    fd = (int)(syscall(SYS_memfd_create, name, 1U /* MFD_CLOEXEC */));
+#else
+    (void)(name);
+#endif /* SYS_memfd_create */
+
+    if (fd < 0) {
+        fprintf(stderr, "[ERROR: cgcs_page_provider_memfd] Unable to create a memory file.\n");
+        return false;
+    }
+
+    *provider = (cgcs_page_provider_t){
+        .m_name = "memfd", .m_reserve = page_fd_reserve, .m_commit = page_mmap_commit,
+        .m_purge = page_fd_purge, .m_release = page_mmap_release, .m_fd = fd
+    };
+
+    return true;
+}
+
+/*!
+    \brief      Fills `provider` with a provider backed by the file at `path`,
+                created if it does not exist, and extended to the reservation.
+
+    \details    The file is mapped shared, so the heap's contents reach it --
+                e.g. a file on a DAX-mounted persistent memory device. Large
+                requests are served from the file as well.
+
+    \param[out] provider    Receives the provider
+    \param[in]  path        Path of the backing file
+
+    \return     `true` on success, `false` if the file could not be opened.
+ */
+bool cgcs_page_provider_file(cgcs_page_provider_t *provider, const char *path) {
+    int fd = path ? open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600) : -1;
+
+    if (fd < 0) {
+        fprintf(stderr, "[ERROR: cgcs_page_provider_file] Unable to open %s.\n", path ? path : "(null)");
+        return false;
+    }
+
+    *provider = (cgcs_page_provider_t){
+        .m_name = "file", .m_reserve = page_fd_reserve, .m_commit = page_mmap_commit,
+        .m_purge = page_fd_purge, .m_release = page_mmap_release, .m_fd = fd
+    };
+
+    return true;
+}
+
+/*!
+    \brief      Makes `provider` the heap's source of memory.
+
+    \details    Must be called before the first allocation: once the heap has
+                reserved its range, or made a large mapping, its provider is fixed.
+                `provider` is copied.
+
+    \param[in]  provider    Filled by one of the `cgcs_page_provider_*` functions, or by hand
+
+    \return     `true` on success, `false` if memory has already been acquired,
+                or a required operation is missing.
+ */
+bool cgcs_page_provider_set(const cgcs_page_provider_t *provider) {
+    if (!provider || !provider->m_reserve || !provider->m_commit || !provider->m_map != !provider->m_unmap) {
+        fprintf(stderr, "[ERROR: cgcs_page_provider_set] A page provider needs m_reserve, m_commit, and either both or neither of m_map and m_unmap.\n");
+        return false;
+    }
+
+    mem_lock_acquire();
+    pthread_mutex_lock(&large_lock);
+
+    bool in_use = mem_is_initialized(&block) || large_cache.m_mapped;
+
+    if (!in_use) {
+        block.m_provider = *provider;
+    }
+
+    pthread_mutex_unlock(&large_lock);
+    mem_lock_release();
+
+    if (in_use) {
+        fprintf(stderr, "[ERROR: cgcs_page_provider_set] The page provider cannot change once memory has been acquired from it.\n");
+    }
+
+    return !in_use;
+}
+
+/*!
+    \brief      Reserves the address range for block, commits its first
+                `CGCS_MALLOC_COMMIT_SIZE` bytes, and assigns it its first
+                header "node" with its starting value(s).
+
+    \details
+    A newly initialized block will have one header/node,
+    with its allocated capacity:
+        `(CGCS_MALLOC_COMMIT_SIZE - sizeof(header_t))`.
+
+        The amount of usable bytes is the
+            committed size of `block` - size of the first header
+
+    \return     `true` on success, `false` if the range could not be reserved
+                or committed.
+ */
+static bool mem_initialize(mem_t *self) {
+    const cgcs_page_provider_t *provider = &self->m_provider;
+    size_t reserved = CGCS_MALLOC_RESERVE_SIZE;
+    char *base = provider->m_reserve(provider, &reserved);
+
+    if (!base) {
+        return false;
+    }
+
+    if ((uintptr_t)(base) % CGCS_MALLOC_ALIGNMENT != 0) {
+        fprintf(stderr, "[ERROR: mem_initialize] Page provider %s reserved memory that is not aligned to %lu bytes.\n",
+                provider->m_name ? provider->m_name : "(unnamed)", (unsigned long)(CGCS_MALLOC_ALIGNMENT));
+
+        if (provider->m_release) {
+            provider->m_release(provider, base, reserved);
+        }
+
+        return false;
+    }
+
+    /*
+        A provider may reserve less than was asked for (a static buffer);
+        `block` must still end on a header boundary, and hold at least one byte.
+     */
+    size_t usable = (reserved < CGCS_MALLOC_RESERVE_SIZE ? reserved : CGCS_MALLOC_RESERVE_SIZE)
+                  & ~(sizeof(header_t) - 1);
+    size_t committed = usable < CGCS_MALLOC_COMMIT_SIZE ? usable : CGCS_MALLOC_COMMIT_SIZE;
+
+    if (committed <= sizeof(header_t) || !provider->m_commit(provider, base, committed)) {
+        if (provider->m_release) {
+            provider->m_release(provider, base, reserved);
+        }
+
+        return false;
+    }
+
+    // `m_base` and `m_committed` are read without `mem_lock` by `mem_snapshot_walk`.
+    __atomic_store_n(&self->m_base, base, __ATOMIC_RELAXED);
+    self->m_reserved = usable;
+    __atomic_store_n(&self->m_committed, committed, __ATOMIC_RELAXED);
+
+    header_store_size((header_t *)(self->m_base), (cgcs_header_size_t)(committed - sizeof(header_t)));
+    return true;
+}
+
+/*!
+    \brief      Determine if `mem_initialize` has set up `block`.
+
+    \return     `true` if `block` has been reserved, `false` otherwise.
+ */
+static inline bool mem_is_initialized(const mem_t *self) {
+    return __atomic_load_n(&self->m_base, __ATOMIC_RELAXED) != NULL;
+}
+
+/*!
+    \brief      Commits more of the reserved range, so that a block of
+                `size` bytes fits at the end of `block`.
+
+    \details    The committed size grows by a multiple of `CGCS_MALLOC_COMMIT_SIZE`.
+                If `last` is free, it absorbs the new memory; otherwise, a new
+                free header is placed right after it. Either way the layout stays
+                contiguous, so `header_next` arithmetic keeps working.
+
+    \param[in]  last    The last header within `block`
+    \param[in]  size    Size of the request that did not fit
+
+    \return     the (free) last header, now holding at least `size` bytes;
+                `NULL` if the reservation is exhausted or the commit failed.
+
+    Precondition: `mem_lock` is held
+ */
+static header_t *mem_grow(mem_t *self, header_t *last, size_t size) {
+    size_t available = header_is_free(last) ? (size_t)(header_alloc_size(last)) : 0;
+    size_t needed = header_is_free(last) ? size - available : size + sizeof *last;
+    size_t growth = (needed + CGCS_MALLOC_COMMIT_SIZE - 1) / CGCS_MALLOC_COMMIT_SIZE * CGCS_MALLOC_COMMIT_SIZE;
+
+    // The last commit of a reservation that is not a multiple of `CGCS_MALLOC_COMMIT_SIZE` takes what is left.
+    if (growth > self->m_reserved - self->m_committed && needed <= self->m_reserved - self->m_committed) {
+        growth = self->m_reserved - self->m_committed;
+    }
+
+    if (growth > self->m_reserved - self->m_committed
+    || !self->m_provider.m_commit(&self->m_provider, self->m_base + self->m_committed, growth)) {
+        return NULL;
+    }
+
+    header_t *grown = (header_t *)(self->m_base + self->m_committed);
+
+    if (header_is_free(last)) {
+        header_store_size(last, last->m_size + (cgcs_header_size_t)(growth));
+        grown = last;
+    } else {
+        header_store_size(grown, (cgcs_header_size_t)(growth - sizeof *grown));
+    }
+
+    __atomic_store_n(&self->m_committed, self->m_committed + growth, __ATOMIC_RELAXED);
+    return grown;
+}
+
+/*
+    \brief    Return the base address of the allocation block 
+              used by the memory allocator functions.
+
+    \return   Address of `block[0]`, as `(void *)`
+*/
+static inline void *mem_first_byte_address(const mem_t *self) {
+    return ((void *)(__atomic_load_n(&self->m_base, __ATOMIC_RELAXED)));
+}
+
+/*!
+    \brief      Return the address of the last committed byte
+                within the allocation block used 
+                by the memory allocation functions.
+
+    \return     Address of `block[committed - 1]`, as `(void *)` 
+ */
+static inline void *mem_last_byte_address(const mem_t *self) {
+    return ((void *)(__atomic_load_n(&self->m_base, __ATOMIC_RELAXED)
+                     + __atomic_load_n(&self->m_committed, __ATOMIC_RELAXED) - 1));
+}
+
+/*!
+    \brief      Return the base address of the allocation block
+                used by the memory allocator functions, as `(header_t *)`
+
+    \return     Address of `block[0]`, as `(header_t *)`
+ */
+static inline header_t *mem_first_header_alignment(const mem_t *self) {
+    return ((header_t *)(self->m_base));
+}
+
+/*!
+    \brief      Return the address of the last `sizeof(header_t)`
+                byte alignment within the committed part of the
+                allocation block used by the memory allocation functions.
+
+    \details    The address of the last `sizeof(header_t)` byte chunk 
+                within [block, block + committed) is returned 
+    
+    \return     Address of `block[committed - sizeof(header_t)]`, as `(header_t *)`
+ */
+static inline header_t *mem_last_possible_header_alignment(const mem_t *self) {
+    return ((header_t *)(self->m_base + (self->m_committed - sizeof(header_t))));
+}
+
+/*!
+    \brief      Stores `size` into `self->m_size`.
+
+    \details    Every write to a header within `block` goes through here,
+                as a relaxed atomic store, because `mem_snapshot_walk` reads
+                the headers without `mem_lock`. Writers still hold the lock,
+                so their own plain reads of `m_size` do not race.
+
+    \param[in]  self    The current `header_t`
+    \param[in]  size    The new `m_size`
+ */
+static inline void header_store_size(header_t *self, cgcs_header_size_t size) {
+    __atomic_store_n(&self->m_size, size, __ATOMIC_RELAXED);
+}
+
+/*!
+    \brief      Return the next header; the header to the "right" of `self`.      
+
+    \details    Advance `(sizeof(header_t) + header_alloc_size(self))` bytes from `self`.
+
+    \param[in]  self    The current `header_t`
+    
+    \return     The address that is `sizeof(header_t)` + `header_alloc_size(self)` away
+                from `self`.
+ */
+static inline header_t *header_next(header_t *self) {
+    return ((header_t *)((char *)(self) + sizeof *self + header_alloc_size(self)));
+}
+
+/*!
+    \brief      Return the absolute value of `self->m_size`.
+
+    \details    A negative value denotes that the block assigned to `self`
+                is in use. A positive value denotes a free block.
+
+    \param[in]  self    The current `header_t`
+    
+    \return     `abs(self->m_size)`
+ */
+static inline cgcs_header_size_t header_alloc_size(header_t *self) {
+    return self->m_size < 0 ? -self->m_size : self->m_size;
+}
+
+/*!
+    \brief      Determine if the block addressed at `(self + 1)` is not in use.
+
+    \param[in]  self    The current `header_t`
+    
+    \return     `true`, if `self->m_size >= 0`, `false` otherwise.
+ */
+static inline bool header_is_free(header_t *self) {
+    return self->m_size >= 0;
+}
+
+/*!
+    \brief      Determine if the block addressed at `(self + 1)` is in use.
+
+    \param[in]  self    The current `header_t`
+    
+    \return     `true`, if `self->m_size < 0`, `false` otherwise.
+ */
+static inline bool header_is_used(header_t *self) {
+    return self->m_size < 0;
+}
+
+/*!
+    \brief      Determine if `self` is the last header within block.
+
+    \details    Invoking `header_next(self)`, if `self` is the last header,
+                should yield the address of the first byte outside of
+                `block`. 
+                
+                Therefore, `header_next(self) - 1` should yield
+                the address of the last `sizeof(header_t)` byte alignment
+                within block.
+
+                If `header_next(self) - 1` is the same address as that of
+                `mem_last_possible_header_alignment(mem)`, `self` is the address
+                of the last `header_t` within `mem`.
+
+    \param[in]  self    The current `header_t`
+    \param[in]  mem     The heap that `self` belongs to
     
-    \return     true,  if ptr < &block || ptr > &block + CGCS_MALLOC_BLOCK_SIZE - 1
-                false, if ptr >= &block && ptr <= &block + CGCS_MALLOC_BLOCK_SIZE - 1
+    \return     `true`, if `self` is the last header in `mem`, `false` otherwise.
+ */
+static inline bool header_is_last(header_t *self, const mem_t *mem) {
+    return header_next(self) - 1 == mem_last_possible_header_alignment(mem);
+}
+
+/*!
+    \brief      Determine the excess byte count if `self->m_size` was reduced
+                to `size_to_keep`.
+
+    \details    This function is used to determine if `self->m_size`
+                can be reduced to `size_to_keep` 
+                such that the portion split away from `self->m_size`
+                (aka the remainder size) is greater than or equal to 1 byte.
+
+    \param[in]  self            The current `header_t`
+    \param[in]  size_to_keep    The desired size for `self->m_size`
+    
+    \return     `self->m_size - size_to_keep - sizeof(header_t)`
+ */
+static inline cgcs_header_size_t header_calculate_split_remainder_size(header_t *self, cgcs_header_size_t size_to_keep) {
+    return ((cgcs_header_size_t)(self->m_size - size_to_keep - (cgcs_header_size_t)(sizeof *self)));
+}
+
+/*!
+    \brief  Coalesces memory referred to by `self` and `self->next`
+            into one block.
+  
+    \param[in]  self    The current `header_t`
+  
+    Precondition: `header_free(self) && header_free(header_next(self))`
+ 
+    This function is called by `cgcs_malloc_impl` or `cgcs_free_impl`, when the precondition
+    above is fulfilled. It is not to be called unless conditions for
+    coalescence are clearly defined.
+ */
+static inline void header_merge_with_next_block(header_t *self) {
+    header_t *next = header_next(self);
+    header_store_size(self, self->m_size + next->m_size + (cgcs_header_size_t)(sizeof *next));
+}
+
+/*!
+    \brief      Mark the block assigned to self as in use, if it is free --
+                otherwise, mark it as free, if it is in use.
+    
+    \details    Used for assigning/reclaiming a block.
+                The two's complement of `self->m_size` is assigned to itself,
+                which effectively amounts to a multiplication by (-1). 
+    
+    \param[in]  self    The current `header_t`
+ */
+static inline void header_toggle_use_status(header_t *self) {
+    header_store_size(self, (~self->m_size) + 1);
+}
+
+/*!
+    \brief      Can be used to check if header has an invalid `m_size` value.
+
+    \details
+    Under normal use, a `header_t` should never have an `m_size` value of 0,
+    nor should it exceed a value of CGCS_MALLOC_RESERVE_SIZE - sizeof(header_t).
+
+    This would only occur if an `header_t`'s `m_size` field was modified directly.
+
+    \param[in]  self    The current `header_t`
+
+    \return     `true`, if `self->m_size == 0 || self->m_size > CGCS_MALLOC_RESERVE_SIZE - sizeof(header_t)`
+                false otherwise.
+ */
+/*
+// UNUSED
+static inline bool header_is_corrupt(header_t *self) {
+    return self->m_size == 0 || self->m_size > CGCS_MALLOC_RESERVE_SIZE - sizeof *self;
+}
+*/
+
+/*!
+    \brief      Determines if `ptr`'s address is less than the first address at block,
+                or if `ptr`'s address is greater than the last address at block.
+
+    \param[in]  ptr     The pointer to assess
+    
+    \return     true,  if ptr < block.m_base || ptr > block.m_base + block.m_committed - 1,
+                       or `block` has not been initialized (a large allocation may precede it)
+                false, if ptr >= block.m_base && ptr <= block.m_base + block.m_committed - 1
+ */
+static inline bool pointer_outside_block_range(const mem_t *mem, void *ptr) {
+    return !mem_is_initialized(mem) || ptr < mem_first_byte_address(mem) || ptr > mem_last_byte_address(mem);
+}
+
+/*!
+    \brief  Creates a new block by partitioning the memory referred to
+            by next into size bytes -- the remaining memory
+            becomes part of the new block created in this function.
+ 
+    Precondition: `header_is_free(self) && header_is_free(header_next(self))`,
+                  else undefined behavior
+ 
+    \param[in] self            The current `header_t`
+    \param[in]  size_to_keep    The desired reduced size for `self->m_size`
+ */
+static void header_split_block(header_t *self, const mem_t *mem, size_t size_to_keep) {
+    /*
+        We want to treat `self` as a `(char *)` --
+        the address of a one-byte figure.
+     
+        That way, when we add any integral values to it,
+        pointer arithmetic becomes standard arithmetic, and we
+        can fine-tune the exact amount of bytes that we want to
+        advance from address `next`.
+     
+        We want to find an address for `new_header`, and we will
+        start from `next`.
+     
+        We will advance `sizeof(header_t)`, or `(sizeof *self)` bytes
+        from `self`, plus the intended size for the block to be split.
+     
+        `(char *)(self) + (sizeof(header_t) + size)`
+     
+        But, we cannot simply assign this to `new_header`, because
+        it has been type-coerced to be a `(char *)`.
+        So, we cast the entirety of the expression to `(header_t *)`,
+        the intended type.
+     
+        `(header_t *)((char *)(self) + (sizeof(header_t) + size))`
+     */
+    header_t *new_header = (header_t *)((char *)(self) + (sizeof *self + size_to_keep));
+
+    /*
+        Address range/input check
+     */
+    if (new_header >= mem_last_possible_header_alignment(mem) || size_to_keep == 0 
+    || size_to_keep >= (mem->m_committed - sizeof *new_header)) {
+        return;
+    }
+
+    /*
+        Now that `new_header` has been given its new home,
+        its values can be assigned.
+     
+        The size of `new_header` will be
+            `self->m_size` (`self`'s size, soon to be former size)
+                minus
+            the requested size, `size_to_keep` (what `self`'s size will become, shortly)
+                minus
+            `sizeof(header_t)`, or `sizeof *new_header`
+      
+        Remember, the header takes up room too, and that is why we must
+        subtract `sizeof(header_t)` (or `sizeof *new_header`) from the overall
+        quantity.
+      
+        The result, `new_header`, is a free (unoccupied) block.
+     */
+    header_store_size(new_header, (self->m_size - size_to_keep) - (cgcs_header_size_t)(sizeof *new_header));
+    header_store_size(self, size_to_keep);    // self will now take on its new size value.
+}
+
+/*!
+    \brief  Traverses the `block` buffer by byte increments of
+            `(sizeof *self + self->m_size)` and merges adjacent free blocks
+            into contigious memory for future allocations.
+  
+    \param[in]  self    The current `header_t`
+ 
+    Precondition: `self != NULL` and `mem_initialize` has been called
+ */
+static void header_coalesce(header_t *self, const mem_t *mem) {
+    header_t *prev = NULL;
+
+    while (self) {
+        /*
+            If the header that was just visited is representing a free block,
+            and the current header is also representing a free block,
+            perform a coalescence between them.
+         */
+        if (prev) {
+            if (header_is_free(prev) && header_is_free(self)) {
+                header_merge_with_next_block(prev);
+
+                /*
+                    `self` now lies inside of `prev` --
+                    continue from `prev`, so its new right neighbour
+                    is also considered.
+                 */
+                self = prev;
+            }
+        }
+
+        /*
+            If we haven't found what we are looking for yet,
+            and self is not the last header, we move on to the next header.
+         */
+        prev = self;
+        self = header_is_last(self, mem) ? NULL : header_next(self);
+    }
+}
+
+/*!
+    \brief      Serves a large request with a mapping of its own,
+                reusing a cached mapping of the same class if there is one.
+
+    \param[in]  size    Requested size, at least `CGCS_MALLOC_LARGE_SIZE`
+
+    \return     address of the client's memory within the mapping,
+                or `NULL` if it could not be mapped.
+ */
+static void *large_alloc(size_t size) {
+    const size_t page_size = (size_t)(sysconf(_SC_PAGESIZE));
+    size_t i = 0;
+
+    while (i < CGCS_MALLOC_LARGE_CLASS_COUNT && (CGCS_MALLOC_LARGE_SIZE << i) < size) {
+        ++i;
+    }
+
+    large_header_t *self = NULL;
+
+    if (i < CGCS_MALLOC_LARGE_CLASS_COUNT) {
+        pthread_mutex_lock(&large_lock);
+
+        if ((self = large_cache.m_free[i])) {
+            large_cache.m_free[i] = self->m_next;
+            large_cache.m_bytes -= self->m_length;
+        }
+
+        pthread_mutex_unlock(&large_lock);
+    }
+
+    if (!self) {
+        size_t length = i < CGCS_MALLOC_LARGE_CLASS_COUNT ?
+                            (CGCS_MALLOC_LARGE_SIZE << i) + page_size :
+                            (size + CGCS_MALLOC_LARGE_OFFSET + page_size - 1) / page_size * page_size;
+
+        if (length < size) {
+            return NULL;
+        }
+
+        pthread_mutex_lock(&large_lock);
+        large_cache.m_mapped = true;
+        pthread_mutex_unlock(&large_lock);
+
+        if (!(self = block.m_provider.m_map(&block.m_provider, length))) {
+            return NULL;
+        }
+
+        self->m_length = length;
+        self->m_class = i;
+    }
+
+    char *ptr = (char *)(self) + CGCS_MALLOC_LARGE_OFFSET;
+
+    atomic_fetch_add_explicit(&large_live_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&large_live_bytes, self->m_length, memory_order_relaxed);
+    self->m_magic = (uintptr_t)(self) ^ CGCS_MALLOC_LARGE_MAGIC;
+    ((header_t *)(ptr) - 1)->m_size = -INT32_MAX;
+
+    return ptr;
+}
+
+/*!
+    \brief      Returns the `large_header_t` of a large allocation.
+
+    \param[in]  ptr     The pointer to assess; outside of `block`
+
+    \return     the mapping's `large_header_t`, if `ptr` is the address of
+                an in-use large allocation; `NULL` otherwise.
+ */
+static large_header_t *large_header_of(void *ptr) {
+    const uintptr_t page_size = (uintptr_t)(sysconf(_SC_PAGESIZE));
+
+    if (!ptr || (uintptr_t)(ptr) % page_size != CGCS_MALLOC_LARGE_OFFSET) {
+        return NULL;
+    }
+
+    large_header_t *self = (large_header_t *)((char *)(ptr) - CGCS_MALLOC_LARGE_OFFSET);
+    return self->m_magic == ((uintptr_t)(self) ^ CGCS_MALLOC_LARGE_MAGIC) ? self : NULL;
+}
+
+/*!
+    \brief      Caches a freed large mapping for reuse, or unmaps it
+                if it has no class or the cache is full.
+
+    \param[in]  self    The mapping's `large_header_t`
+ */
+static void large_free(large_header_t *self) {
+    bool cached = false;
+
+    self->m_magic = ~((uintptr_t)(self) ^ CGCS_MALLOC_LARGE_MAGIC);
+    atomic_fetch_sub_explicit(&large_live_count, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&large_live_bytes, self->m_length, memory_order_relaxed);
+
+    if (self->m_class < CGCS_MALLOC_LARGE_CLASS_COUNT) {
+        clock_gettime(CLOCK_MONOTONIC, &self->m_freed_at);
+
+        pthread_mutex_lock(&large_lock);
+
+        if (large_cache.m_bytes + self->m_length <= CGCS_MALLOC_LARGE_CACHE_BYTES) {
+            self->m_next = large_cache.m_free[self->m_class];
+            large_cache.m_free[self->m_class] = self;
+            large_cache.m_bytes += self->m_length;
+            cached = true;
+        }
+
+        pthread_mutex_unlock(&large_lock);
+    }
+
+    if (!cached) {
+        block.m_provider.m_unmap(&block.m_provider, self, self->m_length);
+    }
+}
+
+/*!
+    \brief      Unmaps cached large mappings that have not been reused
+                for `decay_ms` milliseconds -- or all of them, if `release_all`.
+
+    \details    Called by the maintenance thread, without `mem_lock`.
+
+    \param[in]  decay_ms        How long a mapping may stay cached
+    \param[in]  release_all     `true` to empty the cache regardless of age
+ */
+static void large_cache_decay(unsigned decay_ms, bool release_all) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    large_header_t *expired = NULL;
+
+    pthread_mutex_lock(&large_lock);
+
+    for (size_t i = 0; i < CGCS_MALLOC_LARGE_CLASS_COUNT; ++i) {
+        large_header_t **link = &large_cache.m_free[i];
+
+        while (*link) {
+            large_header_t *self = *link;
+
+            long long cached_ms = (now.tv_sec - self->m_freed_at.tv_sec) * 1000LL
+                                + (now.tv_nsec - self->m_freed_at.tv_nsec) / 1000000LL;
+
+            if (release_all || cached_ms >= decay_ms) {
+                *link = self->m_next;
+                large_cache.m_bytes -= self->m_length;
+
+                self->m_next = expired;
+                expired = self;
+            } else {
+                link = &self->m_next;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&large_lock);
+
+    while (expired) {
+        large_header_t *next = expired->m_next;
+        block.m_provider.m_unmap(&block.m_provider, expired, expired->m_length);
+        expired = next;
+    }
+}
+
+/*!
+    \brief      Takes a block of at least `size` bytes from `self`, first fit:
+                free blocks are merged with their free right neighbours
+                on the way, and `self` grows if none is large enough.
+
+    \param[in]  self    Initialized memory source
+    \param[in]  size    Requested size, a multiple of `sizeof(header_t)`
+
+    \return     the header of the block, now in use and split down to `size`
+                if the remainder can hold a block of its own; `NULL` if
+                no block fits and `self` cannot grow.
+
+    Precondition: the lock guarding `self` is held
+ */
+static header_t *mem_take(mem_t *self, size_t size) {
+    header_t *curr = mem_first_header_alignment(self);
+    header_t *next = NULL;
+    header_t *last = NULL;
+
+    /*
+        We traverse the free list (`self`) and search for
+        a header that is associated with an unused block of memory.
+ 
+        We reject headers denoting occupied blocks,
+        and headers representing blocks of sizes less than what we are
+        looking for.
+ 
+        `curr` becomes `NULL` when there are no more blocks to traverse.
+    */
+    while (curr) {
+        // If curr represents a free block...
+        if (header_is_free(curr)) {
+            /*
+                If `curr`'s right adjacent headers (if applicable)
+                represent free blocks, we can merge them together.
+                This should help to reduce fragmentation in the long run,
+                and picks up any coalescing that `cgcs_free_impl`
+                left to the maintenance thread.
+             */
+            while ((next = header_is_last(curr, self) ? NULL : header_next(curr))
+                   && header_is_free(next)) {
+                header_merge_with_next_block(curr);
+            }
+
+            /*
+                If the block represents by `curr` is greater than or equal
+                to the requested size, we can leave the loop.
+            */
+            if (header_alloc_size(curr) >= size) {
+                break;
+            }
+       }
+
+       last = curr;
+       curr = header_is_last(curr, self) ? NULL : header_next(curr);
+    }
+
+    /*
+        No free block is large enough: commit more of the reserved range
+        after `last`. `self` stays one contiguous run of headers,
+        so the new memory coalesces with a free `last`.
+     */
+    if (!curr && last) {
+        curr = mem_grow(self, last, size);
+    }
+
+    /*
+        If `curr` is non-null, we have found what we are looking for.
+     */
+    if (curr) {
+        /*
+            If the block represented by `curr` is bigger than
+            the requested value, size, it will be split,
+            so that `curr` ends up representing a block with a count of
+            size bytes.
+        
+            However, the split must also result in a second block
+            with enough space to hold a new header representing a block
+            of at least size 1.
+        
+            If the split were to occur such that there was not enough
+            room for a header with a block of at least size 1,
+            the block will not be split.
+        
+            `header_calculate_split_remainder_size(curr, size)` expands to:
+            `curr->m_size - size - sizeof(header_t)`
+        
+            So,
+                the size of the block represented by `curr`
+                    minus
+                the size requested for allocation by the client
+                    minus
+                the size of `(header_t)` -- block metadata.
+        
+            must be greater than or equal to 1
+            to be worth a split.
+        
+            Basically, `curr->m_size` (the size of a candidate block)
+            must be at least (requested size + (`sizeof(header_t)` + 1))
+            in order to qualify for a split.
+        */
+        if (header_calculate_split_remainder_size(curr, size) >= 1) {
+            header_split_block(curr, self, size);
+        }
+
+        // `curr` is now an occupied block.
+        header_toggle_use_status(curr);
+    }
+
+    return curr;
+}
+
+/*!
+    \brief      Allocates size bytes from `block`
+                and returns a pointer to the allocated memory.
+  
+    \param[in]  size        desired memory by user (in bytes)
+    \param[in]  filename    for use with `__FILE__` directive
+    \param[in]  lineno      for use with `__LINE__` directive
+ 
+    \return     on success, a pointer to a block of memory of quantity size.
+                on failure, `NULL`
+ */
+void *cgcs_malloc_impl(size_t size, const char *filename, size_t lineno) {
+    void *ptr = NULL;
+
+    /*
+        Large requests get a mapping of their own (possibly a cached one),
+        instead of a block within `block` -- if the page provider can map.
+     */
+    if (size >= CGCS_MALLOC_LARGE_SIZE && block.m_provider.m_map) {
+        ptr = large_alloc(size);
+
+        if (ptr) {
+            cgcs_stats_count_malloc(size, large_header_of(ptr)->m_length - CGCS_MALLOC_LARGE_OFFSET);
+        } else {
+            fprintf(stderr, "[ERROR: cgcs_malloc_impl] Unable to map %lu bytes.\n", size);
+        }
+
+        return ptr;
+    }
+
+    /*
+        First sanity check: 
+        is the size request within 
+            [1, `CGCS_MALLOC_RESERVE_SIZE` - `sizeof(header_t)` + 1) bytes?
+        If not, do not continue -- return `NULL`.
+     */
+    if (size == 0 || size > (CGCS_MALLOC_RESERVE_SIZE - sizeof(header_t))) {
+       fprintf(stderr, 
+       "[ERROR: cgcs_malloc_impl] Allocation value must be within [1, %lu) bytes.\nAttempted allocation: %lu\n", 
+       CGCS_MALLOC_RESERVE_SIZE - sizeof(header_t) + 1, size);
+    } else {
+        size_t request = size;
+
+        /*
+            The request is rounded up to a multiple of `sizeof(header_t)`,
+            so that every header within `block`, and every allocation after one,
+            stays aligned to `CGCS_MALLOC_ALIGNMENT`.
+         */
+        size = (size + sizeof(header_t) - 1) & ~(sizeof(header_t) - 1);
+
+        mem_lock_acquire();
+
+        /*
+            If `cgcs_malloc_impl` has not been called yet,
+            reserve `block` and initialize the free list by creating a header
+            within block, and giving the header its starting value(s).
+
+            `curr` is the block taken by `mem_take` --
+            or `NULL`, if `block` could not be reserved or has no room.
+         */
+        header_t *curr = mem_is_initialized(&block) || mem_initialize(&block) ? mem_take(&block, size) : NULL;
+
+        if (curr) {
+            /*
+                `ptr` is what will be returned from this function.
+                `curr` + 1 is assigned to `ptr`, because we do not want to return
+                the base address of the allocated block's header --
+                we want to return the base address of the allocated block itself.
+
+                Therefore, we "skip" over the header (metadata) by moving
+                sizeof(header_t) bytes from address `curr`.
+
+                Both
+                    ptr = curr + 1;
+                and
+                    ptr = (char *)(curr) + sizeof(header_t);
+                and
+                    ptr = (char *)(curr) + sizeof *curr;
+                are equivalent.
+
+                `ptr` will now be the base address of the allocation requested by the caller.
+            */
+            ptr = curr + 1;
+        }
+
+        mem_lock_release();
+
+        if (ptr) {
+            cgcs_stats_count_malloc(request, (size_t)(header_alloc_size(curr)));
+        } else {
+            fprintf(stderr, 
+            "[ERROR: cgcs_malloc_impl] Unable to allocate %lu bytes. (header requires at least %lu bytes.)\n", 
+            size, sizeof *curr);
+        }
+    }
+
+    return ptr;
+}
+
+/*!
+    \brief      Frees the space pointer to by `ptr`, which must have been
+                returns by a previous call to `cgcs_malloc_impl`.
+  
+    \param[out]  ptr         address of the memory to free
+    \param[in]   filename    for use with the `__FILE__` directive
+    \param[in]   lineno      for use with the `__LINE__` directive
+ */
+void cgcs_free_impl(void *ptr, const char *filename, size_t lineno) {
+    size_t size = mem_release(ptr);
+
+    if (size > 0) {
+        cgcs_stats_count_free(size);
+    }
+}
+
+/*!
+    \brief      Returns the allocation at `ptr` to `block`, or its mapping
+                to the large cache; the work behind `cgcs_free_impl`.
+
+    \details    Also used to hand back blocks from a thread's cache,
+                which the statistics already counted as freed.
+
+    \param[out] ptr     address of the memory to free
+
+    \return     the usable size that was released, or 0 if `ptr`
+                does not refer to an in-use allocation.
+ */
+static size_t mem_release(void *ptr) {
+    size_t size = 0;
+
+    /*
+        Sanity check:
+            Is `ptr` outside the committed range of `block`?
+            If so, it must be a large allocation -- otherwise, `return`.
+     */
+    if (pointer_outside_block_range(&block, ptr)) {
+        large_header_t *large = large_header_of(ptr);
+
+        if (large) {
+            size = large->m_length - CGCS_MALLOC_LARGE_OFFSET;
+            large_free(large);
+        } else {
+            fprintf(stderr, "[ERROR: cgcs_free_impl] A free was attempted on a pointer that does not refer to a valid allocation by cgcs_malloc_impl.\n");
+        }
+
+        return size;
+    }
+
+    /*
+        `ptr` is the address of the allocation that proceeds its header.
+        To get to the header (and determine its occupancy status/`m_size` value),
+        we type-coerce `ptr` as `(header_t *)`, and decrement the type-coerced address by 1.
+     */
+    header_t *curr = (header_t *)(ptr) - 1;
+
+    mem_lock_acquire();
+
+    if (header_is_used(curr)) {
+        // `curr` will now represent an unoccupied block.
+        // The proceeding block is now free for use.
+        header_toggle_use_status(curr);
+        size = (size_t)(header_alloc_size(curr));
+
+        /*
+            Now that `curr` is marked as free,
+            if `header_next(curr)` is also free,
+            we can merge (coalesce) them.
+         */
+        header_t *next = header_is_last(curr, &block) ? NULL : header_next(curr);
+
+        if (next && header_is_free(next)) {
+            header_merge_with_next_block(curr);
+        }
+
+        /*
+            The entirety of `block` will also be searched for
+            adjacent free blocks to coalesce (combine) --
+            unless the maintenance thread is running, in which case
+            the walk is left to it, off of the caller's path.
+         */
+        if (maintenance.m_running) {
+            maintenance.m_coalesce_pending = true;
+        } else {
+            header_coalesce(mem_first_header_alignment(&block), &block);
+        }
+
+        maintenance_mark_dirty();
+        mem_lock_release();
+    } else {
+        mem_lock_release();
+
+        /*
+            If `curr` reports that this block of memory
+            is already free, there is nothing left to do but
+            report the findings to the user -- return afterward.
+         */
+        fprintf(stderr, 
+        "[ERROR: cgcs_free_impl] Cannot release memory for inactive storage -- did you already call free on this address?\n");        
+    }
+
+    return size;
+}
+
+/*!
+    \brief      Allocates `count` objects of different sizes with one search,
+                laid out next to each other in a single region.
+
+    \details
+    One block large enough for every object (and for the headers between
+    them) is found by `cgcs_malloc_impl`, then carved, with
+    `header_split_block`, into `count` consecutive in-use blocks.
+    Each object has a header of its own, so each is released with
+    `cgcs_free` independently of the others; every object has the
+    alignment of any other `cgcs_malloc` result.
+
+    If the region would be a large allocation, the objects are
+    allocated one at a time instead, and are not adjacent.
+
+    \param[in]  sizes   Requested size of each object, each at least 1 byte
+    \param[in]  count   Number of objects
+    \param[out] out     Receives the address of each object;
+                        every entry is `NULL` on failure
+
+    \return     `true` on success, `false` if any object could not be allocated.
+ */
+bool cgcs_malloc_multi(const size_t *sizes, size_t count, void **out) {
+    size_t total = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = NULL;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (sizes[i] == 0 || total > CGCS_MALLOC_RESERVE_SIZE || sizes[i] > CGCS_MALLOC_RESERVE_SIZE - total) {
+            fprintf(stderr, "[ERROR: cgcs_malloc_multi] Object %lu of %lu bytes cannot be allocated.\n",
+                    (unsigned long)(i), (unsigned long)(sizes[i]));
+            return false;
+        }
+
+        total += (i > 0 ? sizeof(header_t) : 0) + ((sizes[i] + sizeof(header_t) - 1) & ~(sizeof(header_t) - 1));
+    }
+
+    if (count == 0) {
+        return true;
+    }
+
+    /*
+        Large regions would be a single mapping, which cannot be freed piecewise.
+     */
+    if (total >= CGCS_MALLOC_LARGE_SIZE) {
+        for (size_t i = 0; i < count; ++i) {
+            if (!(out[i] = cgcs_malloc_impl(sizes[i], __FILE__, __LINE__))) {
+                while (i > 0) {
+                    cgcs_free_impl(out[--i], __FILE__, __LINE__);
+                    out[i] = NULL;
+                }
+
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void *ptr = cgcs_malloc_impl(total, __FILE__, __LINE__);
+
+    if (!ptr) {
+        return false;
+    }
+
+    /*
+        `curr` is marked free while it is carved, so that every split
+        leaves a free remainder; each object is marked in use as it is cut off.
+        The last object also keeps any slack `cgcs_malloc_impl` did not split off.
+     */
+    header_t *curr = (header_t *)(ptr) - 1;
+
+    mem_lock_acquire();
+
+    header_toggle_use_status(curr);
+
+    for (size_t i = 0; i + 1 < count; ++i) {
+        header_split_block(curr, &block, (sizes[i] + sizeof(header_t) - 1) & ~(sizeof(header_t) - 1));
+        header_toggle_use_status(curr);
+
+        out[i] = curr + 1;
+        curr = header_next(curr);
+    }
+
+    header_toggle_use_status(curr);
+    out[count - 1] = curr + 1;
+
+    mem_lock_release();
+
+    /*
+        `cgcs_malloc_impl` counted one allocation of the whole region;
+        count the objects instead, without the headers between them.
+     */
+    cgcs_stats_write_begin();
+    cgcs_stats_add(&cgcs_stats_slot.m_mallocs, count - 1);
+    cgcs_stats_add(&cgcs_stats_slot.m_bytes_allocated, (uint64_t)(-(count - 1) * sizeof(header_t)));
+    cgcs_stats_add(&cgcs_stats_slot.m_class_mallocs[cgcs_stats_class_index(total)], (uint64_t)(-1));
+
+    for (size_t i = 0; i < count; ++i) {
+        cgcs_stats_add(&cgcs_stats_slot.m_class_mallocs[cgcs_stats_class_index(sizes[i])], 1);
+    }
+
+    cgcs_stats_write_end();
+    return true;
+}
+
+/*!
+    \brief      Returns the usable size `cgcs_malloc_impl` reserves
+                for a request of `size` bytes.
+
+    \details    Mirrors the rounding of `cgcs_malloc_impl`: requests within
+                `block` are rounded up to a multiple of `sizeof(header_t)`,
+                and large requests to the capacity of their mapping.
+                A block within `block` may still end up slightly larger,
+                when the remainder of a free block is too small to split off.
+
+    \param[in]  size    Requested size, in bytes
+
+    \return     the reserved usable size, at least `size` bytes;
+                0 if `size` is 0 or cannot be allocated.
+ */
+size_t cgcs_good_size_impl(size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+
+    if (size < CGCS_MALLOC_LARGE_SIZE || !block.m_provider.m_map) {
+        return size <= CGCS_MALLOC_RESERVE_SIZE - sizeof(header_t) ?
+                   (size + sizeof(header_t) - 1) & ~(sizeof(header_t) - 1) : 0;
+    }
+
+    const size_t page_size = (size_t)(sysconf(_SC_PAGESIZE));
+
+    for (size_t i = 0; i < CGCS_MALLOC_LARGE_CLASS_COUNT; ++i) {
+        if ((CGCS_MALLOC_LARGE_SIZE << i) >= size) {
+            return (CGCS_MALLOC_LARGE_SIZE << i) + page_size - CGCS_MALLOC_LARGE_OFFSET;
+        }
+    }
+
+    // Past the largest class, mappings are only rounded up to whole pages (see `large_alloc`).
+    if (size > SIZE_MAX - CGCS_MALLOC_LARGE_OFFSET - page_size) {
+        return 0;
+    }
+
+    return (size + CGCS_MALLOC_LARGE_OFFSET + page_size - 1) / page_size * page_size - CGCS_MALLOC_LARGE_OFFSET;
+}
+
+/*!
+    \brief      Grows the allocation at `ptr` in place, without moving it.
+
+    \details
+    The block absorbs its free right neighbours, with
+    `header_merge_with_next_block`, until it holds `preferred_size` bytes;
+    if it is the last block within `block`, more of the reserved range is
+    committed instead. Any excess beyond `preferred_size` is split off again.
+
+    If not even `min_size` bytes can be reached, nothing is changed --
+    the caller can then fall back to allocating, moving and freeing.
+    A large allocation can only grow within the mapping it already has.
+
+    \param[in]  ptr             address returned by `cgcs_malloc`
+    \param[in]  min_size        smallest acceptable usable size, in bytes
+    \param[in]  preferred_size  desired usable size, in bytes
+
+    \return     the new usable size of the allocation (at least `min_size`),
+                or 0 if it could not be grown in place.
+ */
+size_t cgcs_try_expand(void *ptr, size_t min_size, size_t preferred_size) {
+    if (preferred_size < min_size) {
+        preferred_size = min_size;
+    }
+
+    if (pointer_outside_block_range(&block, ptr)) {
+        large_header_t *large = large_header_of(ptr);
+
+        if (!large) {
+            fprintf(stderr, "[ERROR: cgcs_try_expand] Expansion was attempted on a pointer that does not refer to a valid allocation by cgcs_malloc_impl.\n");
+            return 0;
+        }
+
+        size_t capacity = large->m_length - CGCS_MALLOC_LARGE_OFFSET;
+        return capacity >= min_size ? capacity : 0;
+    }
+
+    if (min_size > CGCS_MALLOC_RESERVE_SIZE - sizeof(header_t)) {
+        return 0;
+    }
+
+    if (preferred_size > CGCS_MALLOC_RESERVE_SIZE - sizeof(header_t)) {
+        preferred_size = CGCS_MALLOC_RESERVE_SIZE - sizeof(header_t);
+    }
+
+    min_size = (min_size + sizeof(header_t) - 1) & ~(sizeof(header_t) - 1);
+    preferred_size = (preferred_size + sizeof(header_t) - 1) & ~(sizeof(header_t) - 1);
+
+    header_t *curr = (header_t *)(ptr) - 1;
+    size_t result = 0;
+
+    mem_lock_acquire();
+
+    if (!header_is_used(curr)) {
+        mem_lock_release();
+        fprintf(stderr, "[ERROR: cgcs_try_expand] Cannot expand inactive storage -- was this address freed?\n");
+        return 0;
+    }
+
+    /*
+        First, only measure: how much would `curr` hold if it absorbed
+        every consecutive free block to its right?
+     */
+    size_t available = (size_t)(header_alloc_size(curr));
+    header_t *scan = curr;
+
+    while (available < preferred_size && !header_is_last(scan, &block) && header_is_free(header_next(scan))) {
+        scan = header_next(scan);
+        available += sizeof *scan + (size_t)(header_alloc_size(scan));
+    }
+
+    /*
+        Not enough, but there is nothing to the right of the free run --
+        commit more of the reserved range after it.
+     */
+    if (available < min_size && header_is_last(scan, &block)) {
+        size_t extra = preferred_size - available;
+        header_t *grown = NULL;
+
+        if (scan == curr) {
+            grown = mem_grow(&block, scan, extra);
+        } else {
+            grown = mem_grow(&block, scan, (size_t)(header_alloc_size(scan)) + extra);
+        }
+
+        if (grown) {
+            available += grown == scan ? extra : sizeof *grown + (size_t)(header_alloc_size(grown));
+        }
+    }
+
+    size_t before = (size_t)(header_alloc_size(curr));
+
+    if (available >= min_size) {
+
+        /*
+            Now merge for real, with `curr` temporarily marked free,
+            and give back whatever lies beyond `preferred_size`.
+         */
+        header_toggle_use_status(curr);
+
+        while ((size_t)(header_alloc_size(curr)) < preferred_size && !header_is_last(curr, &block)
+               && header_is_free(header_next(curr))) {
+            header_merge_with_next_block(curr);
+        }
+
+        if (header_calculate_split_remainder_size(curr, preferred_size) >= 1) {
+            header_split_block(curr, &block, preferred_size);
+        }
+
+        header_toggle_use_status(curr);
+        result = (size_t)(header_alloc_size(curr));
+    }
+
+    mem_lock_release();
+
+    if (result > before) {
+        if (!cgcs_stats_slot.m_registered && !cgcs_stats_register()) {
+            cgcs_stats_t counts = { .m_bytes_allocated = (uint64_t)(result - before) };
+            cgcs_stats_fold(&counts);
+        } else {
+            cgcs_stats_write_begin();
+            cgcs_stats_add(&cgcs_stats_slot.m_bytes_allocated, (uint64_t)(result - before));
+            cgcs_stats_write_end();
+        }
+    }
+
+    return result;
+}
+
+/*!
+    \brief      Creates an arena that manages `buffer`, memory the caller owns --
+                a static buffer, a DMA region, a device window.
+
+    \details
+    The arena is a heap of its own: first fit, split and coalesce as in
+    `block`, behind a lock of its own. Its bookkeeping is kept at the start
+    of `buffer` itself, so creating one allocates nothing, and makes no
+    system call. No thread cache and no statistics are kept for arenas.
+
+    \param[in]  buffer  Readable and writable memory, which outlives the arena
+    \param[in]  length  Length of `buffer`, in bytes; at most
+                        `CGCS_MALLOC_RESERVE_SIZE` of it is used
+
+    \return     the arena, at an address within `buffer`;
+                `NULL` if `buffer` is too short to hold any allocation.
+ */
+cgcs_arena_t *cgcs_arena_create_in(void *buffer, size_t length) {
+    uintptr_t begin = (uintptr_t)(buffer);
+    uintptr_t aligned = (begin + _Alignof(cgcs_arena_t) - 1) & ~(uintptr_t)(_Alignof(cgcs_arena_t) - 1);
+
+    // Past the arena, the static page provider needs room to align, and for one header and one block.
+    if (!buffer || length < (size_t)(aligned - begin) + sizeof(cgcs_arena_t) + _Alignof(max_align_t) + 2 * sizeof(header_t)) {
+        fprintf(stderr, "[ERROR: cgcs_arena_create_in] A buffer of %lu bytes cannot hold an arena.\n",
+                (unsigned long)(length));
+        return NULL;
+    }
+
+    cgcs_arena_t *self = (cgcs_arena_t *)(aligned);
+    char *rest = (char *)(self + 1);
+
+    memset(self, 0, sizeof *self);
+    pthread_mutex_init(&self->m_lock, NULL);
+
+    // Neither can fail: the static provider commits nothing, and there is room for a block.
+    cgcs_page_provider_static(&self->m_mem.m_provider, rest, length - (size_t)(rest - (char *)(buffer)));
+    mem_initialize(&self->m_mem);
+
+    self->m_magic = (uintptr_t)(self) ^ CGCS_ARENA_MAGIC;
+    return self;
+}
+
+/*!
+    \brief      Determine if `self` is a live arena, made by `cgcs_arena_create_in`.
+ */
+static inline bool arena_is_valid(cgcs_arena_t *self) {
+    return self && self->m_magic == ((uintptr_t)(self) ^ CGCS_ARENA_MAGIC);
+}
+
+/*!
+    \brief      Allocates `size` bytes from `arena`.
+
+    \param[in]  arena   Made by `cgcs_arena_create_in`
+    \param[in]  size    Requested size, in bytes
+
+    \return     on success, a pointer to a block of memory of at least `size` bytes
+                within the arena's buffer; on failure, `NULL`.
+ */
+void *cgcs_arena_alloc(cgcs_arena_t *arena, size_t size) {
+    if (!arena_is_valid(arena)) {
+        fprintf(stderr, "[ERROR: cgcs_arena_alloc] Allocation was attempted from an invalid arena.\n");
+        return NULL;
+    }
+
+    if (size == 0 || size > arena->m_mem.m_reserved - sizeof(header_t)) {
+        fprintf(stderr, "[ERROR: cgcs_arena_alloc] Allocation value must be within [1, %lu) bytes.\nAttempted allocation: %lu\n",
+                (unsigned long)(arena->m_mem.m_reserved - sizeof(header_t) + 1), (unsigned long)(size));
+        return NULL;
+    }
+
+    size = (size + sizeof(header_t) - 1) & ~(sizeof(header_t) - 1);
+
+    pthread_mutex_lock(&arena->m_lock);
+    header_t *curr = mem_take(&arena->m_mem, size);
+    pthread_mutex_unlock(&arena->m_lock);
+
+    if (!curr) {
+        fprintf(stderr, "[ERROR: cgcs_arena_alloc] Unable to allocate %lu bytes.\n", (unsigned long)(size));
+        return NULL;
+    }
+
+    return curr + 1;
+}
+
+/*!
+    \brief      Releases an allocation made by `cgcs_arena_alloc` from the same `arena`.
+
+    \param[in]  arena   Made by `cgcs_arena_create_in`
+    \param[in]  ptr     Allocation to release
+ */
+void cgcs_arena_free(cgcs_arena_t *arena, void *ptr) {
+    if (!arena_is_valid(arena) || pointer_outside_block_range(&arena->m_mem, ptr)) {
+        fprintf(stderr, "[ERROR: cgcs_arena_free] A free was attempted on a pointer that does not refer to a valid allocation by cgcs_arena_alloc.\n");
+        return;
+    }
+
+    header_t *curr = (header_t *)(ptr) - 1;
+    bool released = false;
+
+    pthread_mutex_lock(&arena->m_lock);
+
+    if ((released = header_is_used(curr))) {
+        header_toggle_use_status(curr);
+
+        if (!header_is_last(curr, &arena->m_mem) && header_is_free(header_next(curr))) {
+            header_merge_with_next_block(curr);
+        }
+
+        header_coalesce(mem_first_header_alignment(&arena->m_mem), &arena->m_mem);
+    }
+
+    pthread_mutex_unlock(&arena->m_lock);
+
+    if (!released) {
+        fprintf(stderr, "[ERROR: cgcs_arena_free] Cannot release memory for inactive storage -- did you already call free on this address?\n");
+    }
+}
+
+/*!
+    \brief      Invalidates `arena`. Its buffer belongs to the caller again,
+                along with anything still allocated from it.
+
+    \param[in]  arena   Made by `cgcs_arena_create_in`
+ */
+void cgcs_arena_destroy(cgcs_arena_t *arena) {
+    if (!arena_is_valid(arena)) {
+        fprintf(stderr, "[ERROR: cgcs_arena_destroy] Destruction was attempted on an invalid arena.\n");
+        return;
+    }
+
+    arena->m_magic = 0;
+    pthread_mutex_destroy(&arena->m_lock);
+}
+
+/*!
+    \brief      Creates a pool of `count` slots of `object_size` bytes each,
+                for objects that are allocated and released often,
+                such as queue nodes or timer entries.
+
+    \details
+    All slots are carved from one allocation up front and linked
+    into a free list through their own storage. Allocating pops the head
+    of that list and releasing pushes onto it: no search, no split,
+    no coalescing. Slots are aligned to at least `sizeof(void *)`;
+    the pool never grows.
+
+    \param[in]  object_size     Size of every object, in bytes
+    \param[in]  count           Number of objects the pool holds
+
+    \return     the pool; `NULL` if either argument is zero
+                or its memory could not be allocated.
+ */
+cgcs_pool_t *cgcs_pool_create(size_t object_size, size_t count) {
+    size_t slot_size = (object_size + sizeof(pool_slot_t) - 1) & ~(sizeof(pool_slot_t) - 1);
+    size_t slots_offset = (sizeof(cgcs_pool_t) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
+    size_t bitmap_length = (count + CHAR_BIT - 1) / CHAR_BIT;
+
+    if (object_size == 0 || count == 0 || slot_size < object_size ||
+        count > (SIZE_MAX - slots_offset - bitmap_length) / slot_size) {
+        fprintf(stderr, "[ERROR: cgcs_pool_create] A pool of %lu objects of %lu bytes cannot be created.\n",
+                (unsigned long)(count), (unsigned long)(object_size));
+        return NULL;
+    }
+
+    size_t total = slots_offset + slot_size * count + bitmap_length;
+    char *region = cgcs_malloc_impl(total, __FILE__, __LINE__);
+
+    if (!region) {
+        return NULL;
+    }
+
+    // `cgcs_malloc_impl` aligns `region` for any type, `cgcs_pool_t` included.
+    cgcs_pool_t *self = (cgcs_pool_t *)(region);
+
+    memset(self, 0, sizeof *self);
+    pthread_mutex_init(&self->m_lock, NULL);
+
+    self->m_slots = (char *)(self) + slots_offset;
+    self->m_slot_size = slot_size;
+    self->m_count = count;
+    self->m_in_use = (unsigned char *)(self->m_slots + slot_size * count);
+    memset(self->m_in_use, 0, bitmap_length);
+
+    // Linked from the last slot back, so that the first allocations are the lowest addresses.
+    for (size_t i = count; i > 0; --i) {
+        pool_slot_t *slot = (pool_slot_t *)(self->m_slots + (i - 1) * slot_size);
+        slot->m_next = self->m_free;
+        self->m_free = slot;
+    }
+
+    self->m_region = region;
+    self->m_magic = (uintptr_t)(self) ^ CGCS_POOL_MAGIC;
+    return self;
+}
+
+/*!
+    \brief      Determine if `self` is a live pool, made by `cgcs_pool_create`.
+ */
+static inline bool pool_is_valid(cgcs_pool_t *self) {
+    return self && self->m_magic == ((uintptr_t)(self) ^ CGCS_POOL_MAGIC);
+}
+
+/*!
+    \brief      Takes a slot from `pool`.
+
+    \param[in]  pool    Made by `cgcs_pool_create`
+
+    \return     on success, a pointer to `object_size` bytes;
+                `NULL` if every slot is allocated.
+ */
+void *cgcs_pool_alloc(cgcs_pool_t *pool) {
+    if (!pool_is_valid(pool)) {
+        fprintf(stderr, "[ERROR: cgcs_pool_alloc] Allocation was attempted from an invalid pool.\n");
+        return NULL;
+    }
+
+    pthread_mutex_lock(&pool->m_lock);
+
+    pool_slot_t *slot = pool->m_free;
+
+    if (slot) {
+        size_t i = (size_t)((char *)(slot) - pool->m_slots) / pool->m_slot_size;
+
+        pool->m_free = slot->m_next;
+        pool->m_in_use[i / CHAR_BIT] |= (unsigned char)(1u << (i % CHAR_BIT));
+        ++pool->m_used;
+    }
+
+    pthread_mutex_unlock(&pool->m_lock);
+
+    return slot;
+}
+
+/*!
+    \brief      Returns a slot taken by `cgcs_pool_alloc` to the same `pool`.
+
+    \param[in]  pool    Made by `cgcs_pool_create`
+    \param[in]  ptr     Slot to release
+ */
+void cgcs_pool_free(cgcs_pool_t *pool, void *ptr) {
+    size_t offset = pool_is_valid(pool) ? (size_t)((uintptr_t)(ptr) - (uintptr_t)(pool->m_slots)) : SIZE_MAX;
+
+    // Unsigned, so that a pointer below the first slot is out of range as well.
+    if (offset == SIZE_MAX || offset >= pool->m_slot_size * pool->m_count || offset % pool->m_slot_size != 0) {
+        fprintf(stderr, "[ERROR: cgcs_pool_free] A free was attempted on a pointer that does not refer to a slot of this pool.\n");
+        return;
+    }
+
+    size_t i = offset / pool->m_slot_size;
+    unsigned char bit = (unsigned char)(1u << (i % CHAR_BIT));
+    bool released = false;
+
+    pthread_mutex_lock(&pool->m_lock);
+
+    if ((released = (pool->m_in_use[i / CHAR_BIT] & bit) != 0)) {
+        pool_slot_t *slot = ptr;
+
+        pool->m_in_use[i / CHAR_BIT] &= (unsigned char)(~bit);
+        slot->m_next = pool->m_free;
+        pool->m_free = slot;
+        --pool->m_used;
+    }
+
+    pthread_mutex_unlock(&pool->m_lock);
+
+    if (!released) {
+        fprintf(stderr, "[ERROR: cgcs_pool_free] Cannot release an inactive slot -- did you already call free on this address?\n");
+    }
+}
+
+/*!
+    \brief      Releases `pool` and every slot in it, allocated or not.
+
+    \param[in]  pool    Made by `cgcs_pool_create`
+ */
+void cgcs_pool_destroy(cgcs_pool_t *pool) {
+    if (!pool_is_valid(pool)) {
+        fprintf(stderr, "[ERROR: cgcs_pool_destroy] Destruction was attempted on an invalid pool.\n");
+        return;
+    }
+
+    void *region = pool->m_region;
+
+    pool->m_magic = 0;
+    pthread_mutex_destroy(&pool->m_lock);
+    cgcs_free_impl(region, __FILE__, __LINE__);
+}
+
+/*!
+    \brief      Returns whole pages that lie inside free blocks
+                to the operating system.
+
+    \details    Only the pages strictly between a free block's header
+                and the next header are released, so every header
+                stays resident. The contents of a free block are
+                meaningless, so the zero-fill on next touch is harmless.
+
+                The purge itself runs without `mem_lock`. Up to
+                `CGCS_MALLOC_PURGE_BATCH` free blocks at a time are claimed
+                under the lock, by marking them in use, so that no allocation
+                or merge touches them; the lock is released while their pages
+                are purged, and the blocks are freed again once it is retaken.
+                Meanwhile, readers of the heap count them as in use.
+
+    Precondition: `mem_lock` is held; it is released and retaken.
+ */
+static void mem_purge_free_pages() {
+    const uintptr_t page_size = (uintptr_t)(sysconf(_SC_PAGESIZE));
+    header_t *claimed[CGCS_MALLOC_PURGE_BATCH];
+    header_t *h = mem_first_header_alignment(&block);
+
+    if (!mem_is_initialized(&block) || !block.m_provider.m_purge) {
+        return;
+    }
+
+    while (h) {
+        size_t count = 0;
+
+        for (; h && count < CGCS_MALLOC_PURGE_BATCH; h = header_is_last(h, &block) ? NULL : header_next(h)) {
+            uintptr_t first = ((uintptr_t)(h + 1) + page_size - 1) & ~(page_size - 1);
+            uintptr_t last = (uintptr_t)(header_next(h)) & ~(page_size - 1);
+
+            if (header_is_free(h) && first < last) {
+                header_toggle_use_status(h);
+                claimed[count++] = h;
+            }
+        }
+
+        if (count == 0) {
+            break;
+        }
+
+        mem_lock_release();
+
+        for (size_t i = 0; i < count; ++i) {
+            uintptr_t first = ((uintptr_t)(claimed[i] + 1) + page_size - 1) & ~(page_size - 1);
+            uintptr_t last = (uintptr_t)(header_next(claimed[i])) & ~(page_size - 1);
+
+            block.m_provider.m_purge(&block.m_provider, (void *)(first), last - first);
+        }
+
+        mem_lock_acquire();
+
+        for (size_t i = 0; i < count; ++i) {
+            header_toggle_use_status(claimed[i]);
+        }
+
+        // Claimed blocks stayed in place; blocks after the last of them may have changed.
+        if (h) {
+            h = header_is_last(claimed[count - 1], &block) ? NULL : header_next(claimed[count - 1]);
+        }
+    }
+}
+
+/*!
+    \brief      Records that freed memory is waiting to be purged,
+                starting its decay clock if it is not already running.
+
+    Precondition: `mem_lock` is held
+ */
+static inline void maintenance_mark_dirty() {
+    if (maintenance.m_running && !maintenance.m_dirty) {
+        maintenance.m_dirty = true;
+        clock_gettime(CLOCK_MONOTONIC, &maintenance.m_dirty_since);
+    }
+}
+
+/*!
+    \brief      Finds the cgroup directory of the process, once.
+
+    \details    `CGCS_MALLOC_CGROUP_DIR` takes precedence. Otherwise, the
+                cgroup v2 entry (`0::<path>`) of `/proc/self/cgroup` is
+                resolved under `/sys/fs/cgroup`. `pressure.m_dir` stays empty
+                if neither is available, or if the directory does not fit in it,
+                which disables pressure tracking.
+ */
+static void pressure_resolve_dir() {
+    pressure.m_resolved = true;
+
+    const char *dir = getenv("CGCS_MALLOC_CGROUP_DIR");
+
+    if (dir && *dir) {
+        if (strlen(dir) >= sizeof pressure.m_dir) {
+            fprintf(stderr, "[ERROR: pressure_resolve_dir] CGCS_MALLOC_CGROUP_DIR is longer than %lu bytes; memory pressure is not tracked.\n",
+                    (unsigned long)(sizeof pressure.m_dir - 1));
+            return;
+        }
+
+        snprintf(pressure.m_dir, sizeof pressure.m_dir, "%s", dir);
+        return;
+    }
+
+    FILE *cgroup = fopen("/proc/self/cgroup", "r");
+    char line[sizeof pressure.m_dir - sizeof "/sys/fs/cgroup" + sizeof "0::"]; // fits `m_dir` once prefixed
+    bool line_start = true;
+
+    if (!cgroup) {
+        return;
+    }
+
+    while (fgets(line, sizeof line, cgroup)) {
+        bool whole = strchr(line, '\n') || feof(cgroup);
+
+        if (line_start && strncmp(line, "0::", 3) == 0) {
+            if (!whole) {
+                fprintf(stderr, "[ERROR: pressure_resolve_dir] The cgroup path in /proc/self/cgroup is longer than %lu bytes; memory pressure is not tracked.\n",
+                        (unsigned long)(sizeof line - sizeof "0::"));
+                break;
+            }
+
+            line[strcspn(line, "\n")] = '\0';
+            snprintf(pressure.m_dir, sizeof pressure.m_dir, "/sys/fs/cgroup%s", line + 3);
+            break;
+        }
+
+        // The rest of an overlong line is not the start of another one.
+        line_start = whole;
+    }
+
+    fclose(cgroup);
+}
+
+/*!
+    \brief      Reads a single-value cgroup file, such as `memory.max`.
+
+    \param[in]  file    Name of the file within `pressure.m_dir`
+    \param[out] value   The value read; 0 for `max` (unlimited)
+
+    \return     `true` if the file could be read, `false` otherwise.
+ */
+static bool pressure_read_value(const char *file, unsigned long long *value) {
+    char path[sizeof pressure.m_dir + 32];
+    char text[32] = { 0 };
+
+    snprintf(path, sizeof path, "%s/%s", pressure.m_dir, file);
+
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        return false;
+    }
+
+    bool read = fgets(text, sizeof text, f) != NULL;
+    fclose(f);
+
+    *value = strncmp(text, "max", 3) == 0 ? 0 : strtoull(text, NULL, 10);
+    return read;
+}
+
+/*!
+    \brief      Re-reads the cgroup's limit and pressure, at most every
+                `CGCS_MALLOC_PRESSURE_READ_MS`, and sizes the thread caches
+                for the resulting `mem_pressure_level`.
+
+    \details    Called by the maintenance thread without `mem_lock`;
+                the new level is published under it.
+ */
+static void pressure_update() {
+    if (!pressure.m_resolved) {
+        pressure_resolve_dir();
+    }
+
+    if (pressure.m_dir[0] == '\0') {
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    long long since_read_ms = (now.tv_sec - pressure.m_last_read.tv_sec) * 1000LL
+                            + (now.tv_nsec - pressure.m_last_read.tv_nsec) / 1000000LL;
+
+    if (pressure.m_last_read.tv_sec != 0 && since_read_ms < CGCS_MALLOC_PRESSURE_READ_MS) {
+        return;
+    }
+
+    pressure.m_last_read = now;
+
+    if (!pressure_read_value("memory.max", &pressure.m_max)) {
+        pressure.m_max = 0;
+    }
+
+    if (!pressure_read_value("memory.current", &pressure.m_current)) {
+        pressure.m_current = 0;
+    }
+
+    /*
+        `memory.pressure` holds two lines, of which we want the first:
+            some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+     */
+    char path[sizeof pressure.m_dir + 32];
+    snprintf(path, sizeof path, "%s/memory.pressure", pressure.m_dir);
+
+    FILE *f = fopen(path, "r");
+    pressure.m_some_avg10 = 0.0;
+
+    if (f) {
+        if (fscanf(f, "some avg10=%lf", &pressure.m_some_avg10) != 1) {
+            pressure.m_some_avg10 = 0.0;
+        }
+
+        fclose(f);
+    }
+
+    double usage = pressure.m_max ? (double)(pressure.m_current) / (double)(pressure.m_max) : 0.0;
+
+    enum mem_pressure_level level = MEM_PRESSURE_NORMAL;
+    unsigned limit = CGCS_TCACHE_CLASS_CAPACITY;
+
+    if (pressure.m_some_avg10 >= CGCS_MALLOC_PRESSURE_CRITICAL_AVG10
+    || usage >= CGCS_MALLOC_PRESSURE_CRITICAL_USAGE) {
+        level = MEM_PRESSURE_CRITICAL;
+        limit = 0;
+    } else if (pressure.m_some_avg10 >= CGCS_MALLOC_PRESSURE_ELEVATED_AVG10) {
+        level = MEM_PRESSURE_ELEVATED;
+        limit = CGCS_TCACHE_CLASS_CAPACITY / 4;
+    } else if (pressure.m_max && pressure.m_max < CGCS_MALLOC_PRESSURE_SMALL_CGROUP) {
+        limit = CGCS_TCACHE_CLASS_CAPACITY / 2;
+    }
+
+    atomic_store_explicit(&cgcs_tcache_limit, limit, memory_order_relaxed);
+
+    // The new limit only stops further caching; blocks already cached are drained.
+    if (level > pressure.m_level) {
+        atomic_fetch_add_explicit(&cgcs_tcache_epoch, 1, memory_order_relaxed);
+    }
+
+    mem_lock_acquire();
+    pressure.m_level = level;
+    mem_lock_release();
+}
+
+/*!
+    \brief      Returns how long freed memory stays cached before it is released:
+                `m_decay_ms`, a quarter of it when the cgroup's memory pressure
+                is elevated, and none at all when it is critical.
+
+    \details    Called by the maintenance thread, the only writer of
+                `pressure.m_level`; `m_decay_ms` does not change while it runs.
+ */
+static inline unsigned maintenance_decay_ms() {
+    return pressure.m_level == MEM_PRESSURE_CRITICAL ? 0
+         : pressure.m_level == MEM_PRESSURE_ELEVATED ? maintenance.m_decay_ms / 4
+         : maintenance.m_decay_ms;
+}
+
+/*!
+    \brief      One round of deferred work on `block` for the maintenance thread:
+                the `header_coalesce` pass that `cgcs_free_impl` skipped,
+                and a purge of free pages once they have decayed.
+
+    Precondition: `mem_lock` is held; the purge releases it while it runs.
+ */
+static void maintenance_tick() {
+    long long decay_ms = maintenance_decay_ms();
+
+    if (!mem_is_initialized(&block)) {
+        return;
+    }
+
+    if (maintenance.m_coalesce_pending) {
+        header_coalesce(mem_first_header_alignment(&block), &block);
+        maintenance.m_coalesce_pending = false;
+    }
+
+    if (maintenance.m_dirty) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        long long elapsed_ms = (now.tv_sec - maintenance.m_dirty_since.tv_sec) * 1000LL
+                             + (now.tv_nsec - maintenance.m_dirty_since.tv_nsec) / 1000000LL;
+
+        // Cleared first: blocks freed while the purge has released `mem_lock` start a new decay.
+        if (elapsed_ms >= decay_ms) {
+            maintenance.m_dirty = false;
+            mem_purge_free_pages();
+        }
+    }
+}
+
+/*!
+    \brief      Entry point of the maintenance thread.
+
+    \details    Sleeps on `maintenance.m_wakeup` for `m_interval_ms` at a time
+                (a quarter of it under memory pressure), refreshing the cgroup's
+                memory pressure and running `maintenance_tick` after every wakeup,
+                until `cgcs_maintenance_stop` clears `m_running`. Work that makes
+                system calls without touching `block` -- reading the cgroup,
+                unmapping cached stacks and decayed large mappings,
+                reclaiming idle thread caches -- is done without `mem_lock`.
+
+    \param[in]  arg     unused
+
+    \return     `NULL`
+ */
+static void *maintenance_run(void *arg) {
+    mem_lock_acquire();
+
+    while (maintenance.m_running) {
+        unsigned interval_ms = pressure.m_level == MEM_PRESSURE_NORMAL ?
+                                   maintenance.m_interval_ms :
+                                   (maintenance.m_interval_ms + 3) / 4;
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+
+        deadline.tv_sec += interval_ms / 1000;
+        deadline.tv_nsec += (interval_ms % 1000) * 1000000L;
+
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        mem_sequence_end();
+        pthread_cond_timedwait(&maintenance.m_wakeup, &mem_lock, &deadline);
+        mem_sequence_begin();
+
+        if (maintenance.m_running) {
+            mem_lock_release();
+            pressure_update();
+
+            if (pressure.m_level == MEM_PRESSURE_CRITICAL) {
+                stack_pool_release();
+            }
+
+            large_cache_decay(maintenance_decay_ms(), pressure.m_level == MEM_PRESSURE_CRITICAL);
+            tcache_reclaim_idle(maintenance_decay_ms());
+            mem_lock_acquire();
+        }
+
+        if (maintenance.m_running) {
+            maintenance_tick();
+        }
+    }
+
+    mem_lock_release();
+    return NULL;
+}
+
+/*!
+    \brief      Starts the background maintenance thread.
+
+    \details
+    While the thread is running, `cgcs_free_impl` only merges a block
+    with its right neighbour and leaves the full `header_coalesce` pass
+    to the thread. Pages inside free blocks that have not been reused
+    for `decay_ms` milliseconds are returned to the operating system.
+
+    \param[in]  interval_ms     time between maintenance passes, at least 1
+    \param[in]  decay_ms        how long freed pages are kept before they are purged
+
+    \return     `true` if the thread was started, `false` if it was already
+                running or could not be created
+ */
+bool cgcs_maintenance_start(unsigned interval_ms, unsigned decay_ms) {
+    bool started = false;
+
+    mem_lock_acquire();
+
+    if (!maintenance.m_running) {
+        maintenance.m_running = true;
+        maintenance.m_interval_ms = interval_ms > 0 ? interval_ms : 1;
+        maintenance.m_decay_ms = decay_ms;
+
+        started = pthread_create(&maintenance.m_thread, NULL, maintenance_run, NULL) == 0;
+        maintenance.m_running = started;
+    }
+
+    mem_lock_release();
+
+    if (!started) {
+        fprintf(stderr, "[ERROR: cgcs_maintenance_start] Maintenance thread is already running or could not be created.\n");
+    }
+
+    return started;
+}
+
+/*!
+    \brief      Stops the background maintenance thread, if it is running,
+                and finishes any coalescing it had been deferred.
+ */
+void cgcs_maintenance_stop() {
+    mem_lock_acquire();
+
+    if (!maintenance.m_running) {
+        mem_lock_release();
+        return;
+    }
+
+    maintenance.m_running = false;
+    pthread_cond_signal(&maintenance.m_wakeup);
+    mem_lock_release();
+
+    pthread_join(maintenance.m_thread, NULL);
+
+    mem_lock_acquire();
+
+    if (maintenance.m_coalesce_pending) {
+        header_coalesce(mem_first_header_alignment(&block), &block);
+        maintenance.m_coalesce_pending = false;
+    }
+
+    maintenance.m_dirty = false;
+    mem_lock_release();
+}
+
+/*!
+    \brief      Returns the stack pool class for a stack of `size` bytes.
+
+    \param[in]  size        Requested stack size, in bytes
+    \param[in]  page_size   The system page size
+
+    \return     the smallest `i` such that `(1 << i)` pages hold `size` bytes;
+                `CGCS_STACK_CLASS_COUNT` if `size` is too large for any class.
+ */
+static inline size_t stack_class_index(size_t size, size_t page_size) {
+    size_t pages = (size + page_size - 1) / page_size;
+    size_t i = 0;
+
+    while (i < CGCS_STACK_CLASS_COUNT && ((size_t)(1) << i) < pages) {
+        ++i;
+    }
+
+    return i;
+}
+
+/*!
+    \brief      Unmaps every cached stack, guard pages included.
+
+    \details    Called by the maintenance thread under critical memory pressure,
+                without `mem_lock`. The free lists are only detached under
+                `stack_lock`; the unmapping happens after it is released.
+ */
+static void stack_pool_release() {
+    const size_t page_size = (size_t)(sysconf(_SC_PAGESIZE));
+    stack_node_t *released[CGCS_STACK_CLASS_COUNT];
+
+    pthread_mutex_lock(&stack_lock);
+
+    for (size_t i = 0; i < CGCS_STACK_CLASS_COUNT; ++i) {
+        released[i] = stack_pool.m_free[i];
+        stack_pool.m_free[i] = NULL;
+        stack_pool.m_count[i] = 0;
+    }
+
+    pthread_mutex_unlock(&stack_lock);
+
+    for (size_t i = 0; i < CGCS_STACK_CLASS_COUNT; ++i) {
+        while (released[i]) {
+            stack_node_t *node = released[i];
+            released[i] = node->m_next;
+
+            munmap((char *)(node) - page_size, page_size + (page_size << i));
+        }
+    }
+}
+
+/*!
+    \brief      Returns a stack for a fiber or green thread.
+
+    \details    The stack is preceded by a `PROT_NONE` guard page, so an
+                overflow faults instead of corrupting neighbouring memory.
+                Sizes are rounded up to a power-of-two number of pages;
+                a stack freed with `cgcs_stack_free` is handed out again
+                for the same class without any system call.
+
+    \param[in]  size    Desired usable stack size, in bytes
+
+    \return     the page-aligned lowest address of the stack
+                (the stack grows down from `stack + size`);
+                `NULL` on failure.
+ */
+void *cgcs_stack_alloc(size_t size) {
+    const size_t page_size = (size_t)(sysconf(_SC_PAGESIZE));
+    size_t i = stack_class_index(size, page_size);
+
+    if (size == 0 || i == CGCS_STACK_CLASS_COUNT) {
+        fprintf(stderr, "[ERROR: cgcs_stack_alloc] Stack size must be within [1, %lu] bytes.\nAttempted allocation: %lu\n",
+        (unsigned long)(page_size << (CGCS_STACK_CLASS_COUNT - 1)), (unsigned long)(size));
+        return NULL;
+    }
+
+    pthread_mutex_lock(&stack_lock);
+
+    stack_node_t *node = stack_pool.m_free[i];
+
+    if (node) {
+        stack_pool.m_free[i] = node->m_next;
+        --stack_pool.m_count[i];
+    }
+
+    pthread_mutex_unlock(&stack_lock);
+
+    if (node) {
+        return node;
+    }
+
+    /*
+        No cached stack of this class: map the guard page and the stack
+        together, then open up everything above the guard page.
+     */
+    size_t length = page_size + (page_size << i);
+    char *base = mmap(NULL, length, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "[ERROR: cgcs_stack_alloc] Unable to map a stack of %lu bytes.\n", (unsigned long)(length));
+        return NULL;
+    }
+
+    if (mprotect(base + page_size, page_size << i, PROT_READ | PROT_WRITE) != 0) {
+        munmap(base, length);
+        fprintf(stderr, "[ERROR: cgcs_stack_alloc] Unable to commit a stack of %lu bytes.\n", (unsigned long)(length));
+        return NULL;
+    }
+
+    return base + page_size;
+}
+
+/*!
+    \brief      Returns a stack from `cgcs_stack_alloc` to the pool.
+
+    \details    The mapping is kept for reuse, unless its class already
+                holds `CGCS_STACK_CACHE_CAPACITY` stacks, in which case
+                it is unmapped.
+
+    \param[in]  stack   Address returned by `cgcs_stack_alloc`
+    \param[in]  size    The size that was passed to `cgcs_stack_alloc`
+ */
+void cgcs_stack_free(void *stack, size_t size) {
+    const size_t page_size = (size_t)(sysconf(_SC_PAGESIZE));
+    size_t i = stack_class_index(size, page_size);
+
+    if (!stack || (uintptr_t)(stack) % page_size != 0 || size == 0 || i == CGCS_STACK_CLASS_COUNT) {
+        fprintf(stderr, "[ERROR: cgcs_stack_free] A free was attempted on a stack that does not refer to a valid allocation by cgcs_stack_alloc.\n");
+        return;
+    }
+
+    stack_node_t *node = stack;
+
+    pthread_mutex_lock(&stack_lock);
+
+    if (stack_pool.m_count[i] < CGCS_STACK_CACHE_CAPACITY) {
+        node->m_next = stack_pool.m_free[i];
+        stack_pool.m_free[i] = node;
+        ++stack_pool.m_count[i];
+        node = NULL;
+    }
+
+    pthread_mutex_unlock(&stack_lock);
+
+    if (node) {
+        munmap((char *)(stack) - page_size, page_size + (page_size << i));
+    }
+}
+
+/*!
+    \brief      Creates `tcache_key`; run once, through `tcache_key_once`.
+ */
+static void tcache_key_create() {
+    pthread_key_create(&tcache_key, tcache_destroy);
+}
+
+/*!
+    \brief      Thread-exit destructor for `tcache_key`.
+
+    \param[in]  arg     unused; the exiting thread's `cgcs_tcache` is flushed
+ */
+static void tcache_destroy(void *arg) {
+    pthread_mutex_lock(&tcache_registry.m_lock);
+
+    cgcs_tcache_t **link = &tcache_registry.m_caches;
+
+    while (*link && *link != &cgcs_tcache) {
+        link = &(*link)->m_next;
+    }
+
+    if (*link) {
+        *link = cgcs_tcache.m_next;
+    }
+
+    pthread_mutex_unlock(&tcache_registry.m_lock);
+
+    /*
+        Anything the thread frees from here on (from other destructors)
+        bypasses the cache: a retired cache never grows again.
+     */
+    cgcs_tcache.m_retired = true;
+    cgcs_tcache_flush();
+    tcache_release_budget(SIZE_MAX);
+    memset(cgcs_tcache.m_limit, 0, sizeof cgcs_tcache.m_limit);
+}
+
+/*!
+    \brief      Gives up to `bytes` of the calling thread's share of `tcache_budget` back.
+
+    \details    The share may be smaller than the limits account for,
+                if the maintenance thread took it back in the meantime
+                (`tcache_reclaim_idle`); only what is left is given back.
+
+    \param[in]  bytes   Bytes to give back; `SIZE_MAX` for the whole share
+ */
+static void tcache_release_budget(size_t bytes) {
+    size_t held = atomic_load(&cgcs_tcache.m_budget);
+    size_t released = 0;
+
+    do {
+        released = held < bytes ? held : bytes;
+    } while (!atomic_compare_exchange_weak(&cgcs_tcache.m_budget, &held, held - released));
+
+    atomic_fetch_sub(&tcache_budget, released);
+}
+
+/*!
+    \brief      Makes every other thread of the process execute a full memory barrier.
+
+    \details    Uses `membarrier`, registering the process for its private
+                expedited command on the first call; falls back to the global
+                command where that is missing. Called with `tcache_registry.m_lock`.
+
+    \return     `true` on success, `false` if the kernel offers neither command.
+ */
+static bool tcache_barrier() {
+#ifdef SYS_membarrier
+    if (tcache_registry.m_barrier < 0) {
+        long commands = syscall(SYS_membarrier, 0 /* MEMBARRIER_CMD_QUERY */, 0);
+
+        if (commands > 0 && (commands & 16 /* MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED */)
+        && syscall(SYS_membarrier, 16, 0) == 0) {
+            tcache_registry.m_barrier = 8; // MEMBARRIER_CMD_PRIVATE_EXPEDITED
+        } else if (commands > 0 && (commands & 1 /* MEMBARRIER_CMD_GLOBAL */)) {
+            tcache_registry.m_barrier = 1;
+        } else {
+            tcache_registry.m_barrier = 0;
+        }
+    }
+
+    return tcache_registry.m_barrier > 0 && syscall(SYS_membarrier, tcache_registry.m_barrier, 0) == 0;
+#else
+    tcache_registry.m_barrier = 0;
+    return false;
+#endif /* SYS_membarrier */
+}
+
+/*!
+    \brief      Flushes every cache that was not used for `idle_ms`
+                and takes its budget back, so that busier threads can grow
+                theirs; the caches drop their limits when next used.
+
+    \details    Called by the maintenance thread on every wakeup, without
+                `mem_lock`; first advances `cgcs_tcache_clock`. A cache that was
+                used since the previous wakeup is never idle, however short
+                `idle_ms` is.
+
+                Idle caches are claimed (`m_claimed`) and told to drain,
+                then one `tcache_barrier` makes each thread either see its
+                claim before its next push or pop, or show its `m_busy`.
+                Caches that were not busy are flushed here; busy ones drain
+                themselves, blocks and budget together. Without `membarrier`,
+                every idle cache is left to drain itself.
+
+    \param[in]  idle_ms     How long a cache may go unused before it is reclaimed
+ */
+static void tcache_reclaim_idle(unsigned idle_ms) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    unsigned now_ms = (unsigned)(now.tv_sec * 1000ULL + (unsigned long long)(now.tv_nsec) / 1000000ULL);
+    unsigned previous_ms = atomic_exchange_explicit(&cgcs_tcache_clock, now_ms, memory_order_relaxed);
+    unsigned stale = atomic_load_explicit(&cgcs_tcache_epoch, memory_order_relaxed) - 1;
+    bool claimed = false;
+
+    pthread_mutex_lock(&tcache_registry.m_lock);
+
+    for (cgcs_tcache_t *cache = tcache_registry.m_caches; cache; cache = cache->m_next) {
+        unsigned active_ms = atomic_load_explicit(&cache->m_active, memory_order_relaxed);
+
+        if (active_ms == previous_ms || now_ms - active_ms < idle_ms || atomic_load(&cache->m_budget) == 0) {
+            continue;
+        }
+
+        atomic_store(&cache->m_claimed, true);
+        atomic_store(&cache->m_epoch, stale);
+        claimed = true;
+    }
+
+    if (claimed) {
+        bool flush = tcache_barrier();
+
+        for (cgcs_tcache_t *cache = tcache_registry.m_caches; cache; cache = cache->m_next) {
+            if (!atomic_load_explicit(&cache->m_claimed, memory_order_relaxed)) {
+                continue;
+            }
+
+            if (flush && !atomic_load_explicit(&cache->m_busy, memory_order_acquire)) {
+                tcache_flush(cache);
+                atomic_fetch_sub(&tcache_budget, atomic_exchange(&cache->m_budget, 0));
+            }
+
+            atomic_store_explicit(&cache->m_claimed, false, memory_order_release);
+        }
+    }
+
+    pthread_mutex_unlock(&tcache_registry.m_lock);
+}
+
+/*!
+    \brief      Arranges for the calling thread's cache to be flushed
+                when the thread exits, and makes it visible to the
+                maintenance thread.
+
+    \details    Called by `cgcs_tcache_grow` the first time a thread
+                gives its cache any capacity.
+ */
+void cgcs_tcache_register() {
+    pthread_once(&tcache_key_once, tcache_key_create);
+    pthread_setspecific(tcache_key, &cgcs_tcache);
+
+    pthread_mutex_lock(&tcache_registry.m_lock);
+    cgcs_tcache.m_next = tcache_registry.m_caches;
+    tcache_registry.m_caches = &cgcs_tcache;
+    cgcs_tcache.m_registered = true;
+    pthread_mutex_unlock(&tcache_registry.m_lock);
+}
+
+/*!
+    \brief      Returns every block in `cache` to the allocator with `mem_release`.
+
+    \param[in]  cache   The calling thread's cache, or an idle one
+                        claimed by `tcache_reclaim_idle`
+ */
+static void tcache_flush(cgcs_tcache_t *cache) {
+    for (size_t i = 0; i < CGCS_TCACHE_CLASS_COUNT; ++i) {
+        while (cache->m_count[i] > 0) {
+            mem_release(cache->m_slots[i][--cache->m_count[i]]);
+        }
+
+        cache->m_low[i] = 0;
+    }
+}
+
+/*!
+    \brief      Returns every block in the calling thread's cache
+                to the allocator with `mem_release`.
+ */
+void cgcs_tcache_flush() {
+    tcache_flush(&cgcs_tcache);
+}
+
+/*!
+    \brief      Empties the calling thread's cache and gives up its capacity,
+                after `cgcs_tcache_epoch` changed or the maintenance thread
+                found the cache idle.
+
+    \details    Called by `cgcs_tcache_enter`, so that blocks cached before
+                memory pressure rose go back to `block` as soon as their thread
+                uses its cache again. A cache flushed by `tcache_reclaim_idle`
+                only has its limits left to drop.
+                The limits grow back from 0 as the thread misses.
+ */
+void cgcs_tcache_drain() {
+    cgcs_tcache_flush();
+    tcache_release_budget(SIZE_MAX);
+    memset(cgcs_tcache.m_limit, 0, sizeof cgcs_tcache.m_limit);
+    memset(cgcs_tcache.m_misses, 0, sizeof cgcs_tcache.m_misses);
+
+    atomic_store_explicit(&cgcs_tcache.m_epoch,
+                          atomic_load_explicit(&cgcs_tcache_epoch, memory_order_relaxed), memory_order_relaxed);
+}
+
+/*!
+    \brief      Raises the limit of one class of the calling thread's cache,
+                after `CGCS_TCACHE_GROW_MISSES` misses.
+
+    \details    Called by `cgcs_tcache_pop`. The limit doubles (from 0 to 2),
+                up to `CGCS_TCACHE_CLASS_CAPACITY`, unless that would take
+                all threads' limits past `CGCS_TCACHE_TOTAL_BYTES`.
+
+    \param[in]  index   The class that missed
+ */
+void cgcs_tcache_grow(size_t index) {
+    cgcs_tcache.m_misses[index] = 0;
+
+    if (cgcs_tcache.m_retired) {
+        return;
+    }
+
+    unsigned limit = cgcs_tcache.m_limit[index];
+    unsigned grown = limit > 0 ? limit * 2 : 2;
+
+    if (grown > CGCS_TCACHE_CLASS_CAPACITY) {
+        grown = CGCS_TCACHE_CLASS_CAPACITY;
+    }
+
+    size_t bytes = (grown - limit) * CGCS_TCACHE_CLASS_SIZE(index);
+
+    if (bytes == 0) {
+        return;
+    }
+
+    if (atomic_fetch_add(&tcache_budget, bytes) + bytes > CGCS_TCACHE_TOTAL_BYTES) {
+        atomic_fetch_sub(&tcache_budget, bytes);
+        return;
+    }
+
+    if (!cgcs_tcache.m_registered) {
+        cgcs_tcache_register();
+    }
+
+    atomic_fetch_add(&cgcs_tcache.m_budget, bytes);
+    cgcs_tcache.m_limit[index] = (uint8_t)(grown);
+}
+
+/*!
+    \brief      Halves the limit of every class of the calling thread's cache
+                whose blocks sat unused since the last call.
+
+    \details    Called by `cgcs_tcache_push` every `CGCS_TCACHE_ADAPT_PERIOD` frees.
+                A class that never dropped below `m_low` blocks in that time
+                had `m_low` blocks more than it needed; blocks beyond the
+                halved limit are returned with `mem_release`.
+ */
+void cgcs_tcache_adapt() {
+    for (size_t i = 0; i < CGCS_TCACHE_CLASS_COUNT; ++i) {
+        if (cgcs_tcache.m_low[i] > 0) {
+            unsigned limit = cgcs_tcache.m_limit[i];
+            unsigned shrunk = limit / 2;
+
+            while (cgcs_tcache.m_count[i] > shrunk) {
+                mem_release(cgcs_tcache.m_slots[i][--cgcs_tcache.m_count[i]]);
+            }
+
+            tcache_release_budget((limit - shrunk) * CGCS_TCACHE_CLASS_SIZE(i));
+            cgcs_tcache.m_limit[i] = (uint8_t)(shrunk);
+        }
+
+        cgcs_tcache.m_low[i] = cgcs_tcache.m_count[i];
+    }
+}
+
+/*!
+    \brief      Creates `stats_registry.m_key`; run once, through `stats_registry.m_key_once`.
+ */
+static void stats_key_create() {
+    pthread_key_create(&stats_registry.m_key, stats_retire);
+}
+
+/*!
+    \brief      Adds the counters of `slot` to `stats`.
+
+    \details    The counters are copied until the copy was made while
+                `slot->m_sequence` was even and unchanged -- i.e. not during
+                an update by the owning thread, which never blocks on readers.
+ */
+static void stats_accumulate(cgcs_stats_t *stats, cgcs_stats_slot_t *slot) {
+    cgcs_stats_t copy;
+    unsigned before = 0;
+    unsigned after = 0;
+
+    do {
+        before = atomic_load_explicit(&slot->m_sequence, memory_order_acquire);
+
+        copy.m_mallocs = atomic_load_explicit(&slot->m_mallocs, memory_order_relaxed);
+        copy.m_frees = atomic_load_explicit(&slot->m_frees, memory_order_relaxed);
+        copy.m_bytes_allocated = atomic_load_explicit(&slot->m_bytes_allocated, memory_order_relaxed);
+        copy.m_bytes_freed = atomic_load_explicit(&slot->m_bytes_freed, memory_order_relaxed);
+
+        for (size_t i = 0; i < CGCS_STATS_CLASS_COUNT; ++i) {
+            copy.m_class_mallocs[i] = atomic_load_explicit(&slot->m_class_mallocs[i], memory_order_relaxed);
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&slot->m_sequence, memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+
+    stats->m_mallocs += copy.m_mallocs;
+    stats->m_frees += copy.m_frees;
+    stats->m_bytes_allocated += copy.m_bytes_allocated;
+    stats->m_bytes_freed += copy.m_bytes_freed;
+
+    for (size_t i = 0; i < CGCS_STATS_CLASS_COUNT; ++i) {
+        stats->m_class_mallocs[i] += copy.m_class_mallocs[i];
+    }
+}
+
+/*!
+    \brief      Thread-exit destructor for `stats_registry.m_key`; folds the exiting
+                thread's counters into `stats_registry.m_retired` and unregisters its slot.
+
+    \param[in]  arg     The exiting thread's `cgcs_stats_slot`
+ */
+static void stats_retire(void *arg) {
+    cgcs_stats_slot_t *self = arg;
+
+    pthread_mutex_lock(&stats_registry.m_lock);
+
+    cgcs_stats_slot_t **link = &stats_registry.m_slots;
+
+    while (*link && *link != self) {
+        link = &(*link)->m_next;
+    }
+
+    if (*link) {
+        *link = self->m_next;
+    }
+
+    stats_accumulate(&stats_registry.m_retired, self);
+
+    pthread_mutex_unlock(&stats_registry.m_lock);
+
+    /*
+        The slot is about to be freed with the thread's storage, so it is
+        never registered again: anything counted from here on (its cache,
+        other destructors) goes straight to `m_retired`, see `cgcs_stats_fold`.
+     */
+    memset(self, 0, sizeof *self);
+    self->m_retired = true;
+}
+
+/*!
+    \brief      Makes the calling thread's `cgcs_stats_slot` visible to
+                `cgcs_stats_read`, and arranges for it to be retired
+                when the thread exits.
+
+    \details    Called the first time a thread's allocations are counted.
+
+    \return     `true` if the slot is registered; `false` if the thread
+                is exiting and its slot was already retired, in which case
+                the caller counts with `cgcs_stats_fold` instead.
+ */
+bool cgcs_stats_register() {
+    if (cgcs_stats_slot.m_retired) {
+        return false;
+    }
+
+    pthread_once(&stats_registry.m_key_once, stats_key_create);
+
+    pthread_mutex_lock(&stats_registry.m_lock);
+    cgcs_stats_slot.m_next = stats_registry.m_slots;
+    stats_registry.m_slots = &cgcs_stats_slot;
+    cgcs_stats_slot.m_registered = true;
+    pthread_mutex_unlock(&stats_registry.m_lock);
+
+    pthread_setspecific(stats_registry.m_key, &cgcs_stats_slot);
+    return true;
+}
+
+/*!
+    \brief      Adds `counts` straight to the totals of exited threads.
+
+    \details    Used for allocations and frees made by a thread after its
+                slot was retired, from its cache flush or other thread-exit
+                destructors.
+
+    \param[in]  counts  Counters to add
+ */
+void cgcs_stats_fold(const cgcs_stats_t *counts) {
+    pthread_mutex_lock(&stats_registry.m_lock);
+
+    stats_registry.m_retired.m_mallocs += counts->m_mallocs;
+    stats_registry.m_retired.m_frees += counts->m_frees;
+    stats_registry.m_retired.m_bytes_allocated += counts->m_bytes_allocated;
+    stats_registry.m_retired.m_bytes_freed += counts->m_bytes_freed;
+
+    for (size_t i = 0; i < CGCS_STATS_CLASS_COUNT; ++i) {
+        stats_registry.m_retired.m_class_mallocs[i] += counts->m_class_mallocs[i];
+    }
+
+    pthread_mutex_unlock(&stats_registry.m_lock);
+}
+
+/*!
+    \brief      Sums the allocation counters of every thread,
+                live or exited, into `stats`.
+
+    \details    Allocating threads are never stopped or slowed down;
+                each counter is read as it is at that moment.
+
+    \param[out] stats   Receives the totals
+ */
+void cgcs_stats_read(cgcs_stats_t *stats) {
+    pthread_mutex_lock(&stats_registry.m_lock);
+
+    *stats = stats_registry.m_retired;
+
+    for (cgcs_stats_slot_t *slot = stats_registry.m_slots; slot; slot = slot->m_next) {
+        stats_accumulate(stats, slot);
+    }
+
+    pthread_mutex_unlock(&stats_registry.m_lock);
+}
+
+/*!
+    \brief      Walks the headers of `block` once, without `mem_lock`.
+
+    \details    Every header is read with a relaxed atomic load, paired with
+                the stores of `header_store_size`, and checked against the
+                committed range, so a walk that races with a change to `block`
+                stops early instead of leaving it; the caller validates the
+                walk with `mem_sequence`.
+
+    \param[out] summary     Receives the totals of the blocks walked
+    \param[out] sizes       Receives the `m_size` of each block; may be `NULL`
+    \param[in]  capacity    Entries of `sizes`
+
+    \return     the number of blocks walked, which may exceed `capacity`.
+ */
+static size_t mem_snapshot_walk(cgcs_heap_summary_t *summary, cgcs_header_size_t *sizes, size_t capacity) {
+    char *base = __atomic_load_n(&block.m_base, __ATOMIC_RELAXED);
+    size_t committed = base ? __atomic_load_n(&block.m_committed, __ATOMIC_RELAXED) : 0;
+    size_t offset = 0;
+    size_t count = 0;
+
+    memset(summary, 0, sizeof *summary);
+    summary->m_committed = committed;
+
+    while (offset + sizeof(header_t) <= committed) {
+        cgcs_header_size_t size = __atomic_load_n(&((header_t *)(base + offset))->m_size, __ATOMIC_RELAXED);
+        size_t length = size < 0 ? (size_t)(-(int64_t)(size)) : (size_t)(size);
+
+        if (length == 0 || length > committed - offset - sizeof(header_t)) {
+            break;
+        }
+
+        if (sizes && count < capacity) {
+            sizes[count] = size;
+        }
+
+        if (size < 0) {
+            ++summary->m_used_blocks;
+            summary->m_used_bytes += length;
+        } else {
+            ++summary->m_free_blocks;
+            summary->m_free_bytes += length;
+            summary->m_largest_free = length > summary->m_largest_free ? length : summary->m_largest_free;
+        }
+
+        ++count;
+        offset += sizeof(header_t) + length;
+    }
+
+    return count;
+}
+
+/*!
+    \brief      Takes a consistent snapshot of the headers of `block`.
+
+    \details    Optimistic: the walk runs without `mem_lock`, and is kept
+                if `mem_sequence` was even and unchanged across it. After
+                `CGCS_MALLOC_SNAPSHOT_RETRIES` failed attempts, the walk runs
+                under `mem_lock`, so a reader cannot be starved by a busy heap.
+
+    \param[out] summary     Receives the totals of every block
+    \param[out] sizes       Receives the `m_size` of each block; may be `NULL`
+    \param[in]  capacity    Entries of `sizes`
+
+    \return     the number of blocks, which may exceed `capacity`.
+ */
+static size_t mem_snapshot(cgcs_heap_summary_t *summary, cgcs_header_size_t *sizes, size_t capacity) {
+    for (unsigned attempt = 0; attempt < CGCS_MALLOC_SNAPSHOT_RETRIES; ++attempt) {
+        unsigned before = atomic_load_explicit(&mem_sequence, memory_order_acquire);
+
+        if ((before & 1) != 0) {
+            sched_yield();
+            continue;
+        }
+
+        size_t count = mem_snapshot_walk(summary, sizes, capacity);
+
+        atomic_thread_fence(memory_order_acquire);
+
+        if (atomic_load_explicit(&mem_sequence, memory_order_relaxed) == before) {
+            return count;
+        }
+    }
+
+    mem_lock_acquire();
+    size_t count = mem_snapshot_walk(summary, sizes, capacity);
+    mem_lock_release();
+
+    return count;
+}
+
+/*!
+    \brief      Maps a buffer for the `sizes` of `mem_snapshot`.
+
+    \details    Every block takes at least `2 * sizeof(header_t)` bytes, which
+                bounds the copy; blocks committed after the buffer was sized
+                are left out, and `mem_snapshot` returns more than `*capacity`.
+
+    \param[out] capacity    Receives the entries of the buffer
+    \param[out] length      Receives the length of the mapping, for `munmap`
+
+    \return     the buffer, or `NULL` if it could not be mapped.
  */
-static inline bool pointer_outside_block_range(void *ptr) {
-    return ptr < mem_first_byte_address() || ptr > mem_last_byte_address();
+static cgcs_header_size_t *mem_snapshot_map(size_t *capacity, size_t *length) {
+    size_t committed = __atomic_load_n(&block.m_base, __ATOMIC_RELAXED) ?
+                           __atomic_load_n(&block.m_committed, __ATOMIC_RELAXED) : 0;
+
+    *capacity = committed / (2 * sizeof(header_t)) + 64;
+    *length = *capacity * sizeof(cgcs_header_size_t);
+
+    cgcs_header_size_t *sizes = mmap(NULL, *length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return sizes == MAP_FAILED ? NULL : sizes;
 }
 
 /*!
-    \brief  Creates a new block by partitioning the memory referred to
-            by next into size bytes -- the remaining memory
-            becomes part of the new block created in this function.
- 
-    Precondition: `header_is_free(self) && header_is_free(header_next(self))`,
-                  else undefined behavior
- 
-    \param[in] self            The current `header_t`
-    \param[in]  size_to_keep    The desired reduced size for `self->m_size`
+    \brief      Fills `summary` with the totals of the blocks within the heap,
+                and the lengths of the large mappings outside of it.
+
+    \details    Allocating threads are not stopped; see `mem_snapshot`.
+                `m_committed + m_large_bytes + m_large_cached` is the
+                allocator's footprint, whichever page provider is in use.
+
+    \param[out] summary     Receives the totals
  */
-static void header_split_block(header_t *self, size_t size_to_keep) {
-    /*
-        We want to treat `self` as a `(char *)` --
-        the address of a one-byte figure.
-     
-        That way, when we add any integral values to it,
-        pointer arithmetic becomes standard arithmetic, and we
-        can fine-tune the exact amount of bytes that we want to
-        advance from address `next`.
-     
-        We want to find an address for `new_header`, and we will
-        start from `next`.
-     
-        We will advance `sizeof(header_t)`, or `(sizeof *self)` bytes
-        from `self`, plus the intended size for the block to be split.
-     
-        `(char *)(self) + (sizeof(header_t) + size)`
-     
-        But, we cannot simply assign this to `new_header`, because
-        it has been type-coerced to be a `(char *)`.
-        So, we cast the entirety of the expression to `(header_t *)`,
-        the intended type.
-     
-        `(header_t *)((char *)(self) + (sizeof(header_t) + size))`
-     */
-    header_t *new_header = (header_t *)((char *)(self) + (sizeof *self + size_to_keep));
+void cgcs_heap_summary(cgcs_heap_summary_t *summary) {
+    mem_snapshot(summary, NULL, 0);
 
-    /*
-        Address range/input check
-     */
-    if (new_header >= mem_last_possible_header_alignment() || size_to_keep == 0 
-    || size_to_keep >= (CGCS_MALLOC_BLOCK_SIZE - sizeof *new_header)) {
-        return;
-    }
+    summary->m_large_count = atomic_load_explicit(&large_live_count, memory_order_relaxed);
+    summary->m_large_bytes = atomic_load_explicit(&large_live_bytes, memory_order_relaxed);
 
-    /*
-        Now that `new_header` has been given its new home,
-        its values can be assigned.
-     
-        The size of `new_header` will be
-            `self->m_size` (`self`'s size, soon to be former size)
-                minus
-            the requested size, `size_to_keep` (what `self`'s size will become, shortly)
-                minus
-            `sizeof(header_t)`, or `sizeof *new_header`
-      
-        Remember, the header takes up room too, and that is why we must
-        subtract `sizeof(header_t)` (or `sizeof *new_header`) from the overall
-        quantity.
-      
-        The result, `new_header`, is a free (unoccupied) block.
-     */
-    new_header->m_size = (self->m_size - size_to_keep) - sizeof *new_header;
-    self->m_size = size_to_keep;    // self will now take on its new size value.
+    pthread_mutex_lock(&large_lock);
+    summary->m_large_cached = large_cache.m_bytes;
+    pthread_mutex_unlock(&large_lock);
 }
 
 /*!
-    \brief  Traverses the `block` buffer by byte increments of
-            `(sizeof *self + self->m_size)` and merges adjacent free blocks
-            into contigious memory for future allocations.
-  
-    \param[in]  self    The current `header_t`
- 
-    Precondition: `self != NULL` and `mem_initialize` has been called
+    \brief      Writes a heap profile of the allocator to `dest`.
+
+    \details
+    The profile is plain text, one record per line:
+
+    ```
+    cgcs_heap_profile 1
+    pid 4242
+    time 1760745600.123
+    committed 65536
+    header 4
+    mallocs 1200
+    frees 1100
+    bytes_allocated 52000
+    bytes_freed 48000
+    class 0 310
+    ...
+    large_cached 0
+    blocks 3
+    block 0 60 used
+    block 64 28 free
+    block 96 65436 free
+    end
+    ```
+
+    `class i n` lists the allocations of request class `i` (see `cgcs_stats_t`),
+    `block offset size state` every block within `block`, in address order:
+    the offset of its header from the start of `block`, its usable size,
+    and `used` or `free`. Blocks held by a thread's cache are `used`.
+
+    The headers are copied by `mem_snapshot`, without holding up
+    allocating threads, and written out afterwards.
+
+    \param[in]  dest    Stream to write the profile to
+
+    \return     `true` on success, `false` if the profile could not be captured
+                or written in full.
  */
-static void header_coalesce(header_t *self) {
-    header_t *prev = NULL;
+bool cgcs_profile_fputs(FILE *dest) {
+    cgcs_stats_t stats;
+    cgcs_stats_read(&stats);
 
-    while (self) {
-        /*
-            If the header that was just visited is representing a free block,
-            and the current header is also representing a free block,
-            perform a coalescence between them.
-         */
-        if (prev) {
-            if (header_is_free(prev) && header_is_free(self)) {
-                header_merge_with_next_block(prev);
-            }
-        }
+    size_t large_count = atomic_load_explicit(&large_live_count, memory_order_relaxed);
+    size_t large_bytes = atomic_load_explicit(&large_live_bytes, memory_order_relaxed);
 
-        /*
-            If we haven't found what we are looking for yet,
-            and self is not the last header, we move on to the next header.
-         */
-        prev = self;
-        self = header_is_last(self) ? NULL : header_next(self);
+    pthread_mutex_lock(&large_lock);
+    size_t large_cached = large_cache.m_bytes;
+    pthread_mutex_unlock(&large_lock);
+
+    // Blocks committed after the buffer was sized are reported as truncated.
+    size_t capacity = 0;
+    size_t length = 0;
+    cgcs_header_size_t *sizes = mem_snapshot_map(&capacity, &length);
+
+    if (!sizes) {
+        fprintf(stderr, "[ERROR: cgcs_profile_fputs] Unable to map %lu bytes for the heap profile.\n", (unsigned long)(length));
+        return false;
+    }
+
+    cgcs_heap_summary_t summary;
+    size_t count = mem_snapshot(&summary, sizes, capacity);
+    bool truncated = count > capacity;
+
+    count = truncated ? capacity : count;
+    size_t committed = summary.m_committed;
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    fprintf(dest, "cgcs_heap_profile %d\n", CGCS_PROFILE_VERSION);
+    fprintf(dest, "pid %ld\n", (long)(getpid()));
+    fprintf(dest, "time %ld.%03ld\n", (long)(now.tv_sec), now.tv_nsec / 1000000L);
+    fprintf(dest, "committed %lu\n", (unsigned long)(committed));
+    fprintf(dest, "header %lu\n", (unsigned long)(sizeof(header_t)));
+    fprintf(dest, "mallocs %llu\n", (unsigned long long)(stats.m_mallocs));
+    fprintf(dest, "frees %llu\n", (unsigned long long)(stats.m_frees));
+    fprintf(dest, "bytes_allocated %llu\n", (unsigned long long)(stats.m_bytes_allocated));
+    fprintf(dest, "bytes_freed %llu\n", (unsigned long long)(stats.m_bytes_freed));
+
+    for (size_t i = 0; i < CGCS_STATS_CLASS_COUNT; ++i) {
+        fprintf(dest, "class %lu %llu\n", (unsigned long)(i), (unsigned long long)(stats.m_class_mallocs[i]));
+    }
+
+    fprintf(dest, "large_count %lu\n", (unsigned long)(large_count));
+    fprintf(dest, "large_bytes %lu\n", (unsigned long)(large_bytes));
+    fprintf(dest, "large_cached %lu\n", (unsigned long)(large_cached));
+    fprintf(dest, "blocks %lu%s\n", (unsigned long)(count), truncated ? " truncated" : "");
+
+    size_t offset = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        unsigned long size = (unsigned long)(sizes[i] < 0 ? -sizes[i] : sizes[i]);
+
+        fprintf(dest, "block %lu %lu %s\n", (unsigned long)(offset), size, sizes[i] < 0 ? "used" : "free");
+        offset += sizeof(header_t) + size;
     }
+
+    fprintf(dest, "end\n");
+
+    munmap(sizes, length);
+    return !ferror(dest);
 }
 
 /*!
-    \brief      Allocates size bytes from `block`
-                and returns a pointer to the allocated memory.
-  
-    \param[in]  size        desired memory by user (in bytes)
-    \param[in]  filename    for use with `__FILE__` directive
-    \param[in]  lineno      for use with `__LINE__` directive
- 
-    \return     on success, a pointer to a block of memory of quantity size.
-                on failure, `NULL`
+    \brief      Writes the path of snapshot `n` to `path`.
  */
-void *cgcs_malloc_impl(size_t size, const char *filename, size_t lineno) {
-    /*
-        If `cgcs_malloc_impl` has not been called yet,
-        initialize the free list by creating a header
-        within block, and giving the header its starting value(s).
-     */
-    if (mem_first_header_alignment()->m_size == 0) {
-        mem_initialize();
-    }
+static void profile_path(char *path, size_t length, unsigned long n) {
+    snprintf(path, length, "%s/cgcs_profile.%ld.%06lu.txt", profile.m_dir, (long)(getpid()), n);
+}
 
-    void *ptr = NULL;
+/*!
+    \brief      Writes the next snapshot, then removes the oldest ones
+                until the rest fit within `profile.m_max_bytes`.
 
-    /*
-        First sanity check: 
-        is the size request within 
-            [1, `CGCS_MALLOC_BLOCK_SIZE` - `sizeof(header_t)` + 1) bytes?
-        If not, do not continue -- return `NULL`.
-     */
-    if (size == 0 || size > (CGCS_MALLOC_BLOCK_SIZE - sizeof(header_t))) {
-       fprintf(stderr, 
-       "[ERROR: cgcs_malloc_impl] Allocation value must be within [1, %lu) bytes.\nAttempted allocation: %lu\n", 
-       CGCS_MALLOC_BLOCK_SIZE - sizeof(header_t) + 1, size);
-    } else {
-        /*
-            Cursor variable `curr` is set to the base address of `block`.
-         */
-        header_t *curr = (header_t *)(block);
-        header_t *next = NULL;
+    \details    A snapshot is written to a temporary file and renamed into
+                place, so a reader never sees a partial one. The newest
+                snapshot is always kept, however large it is.
 
-        /*
-            We traverse the free list (block) and search for
-            a header that is associated with an unused block of memory.
-     
-            We reject headers denoting occupied blocks,
-            and headers representing blocks of sizes less than what we are
-            looking for.
-     
-            `curr` becomes `NULL` when there are no more blocks to traverse.
+    Precondition: `profile.m_lock` is held
+ */
+static void profile_snapshot() {
+    char path[sizeof profile.m_dir + 64];
+    char temp[sizeof path + 8];
 
-            On each iteration of the `while` loop,
-            we retrieve the "lookahead" header from position `curr`.
-        */
-        while ((next = header_is_last(curr) ? NULL : header_next(curr))) {
-            // If curr represents a free block...
-            if (header_is_free(curr)) {
-                /*
-                    If `curr`'s right adjacent header (if applicable)
-                    represents a free block, we can merge them together.
-                    This should help to reduce fragmentation in the long run.
-                 */
-                if (next && header_is_free(next)) {
-                    header_merge_with_next_block(curr);
-                }
+    profile_path(path, sizeof path, profile.m_next);
+    snprintf(temp, sizeof temp, "%s.tmp", path);
 
-                /*
-                    If the block represents by `curr` is greater than or equal
-                    to the requested size, we can leave the loop.
-                */
-                if (header_alloc_size(curr) >= size) {
-                    break;
-                }
-           }
+    FILE *f = fopen(temp, "w");
 
-           curr = next;
-        }
+    if (!f) {
+        fprintf(stderr, "[ERROR: cgcs_profile_start] Unable to open %s.\n", temp);
+        return;
+    }
 
-        /*
-            If `curr` is non-null, we have found what we are looking for.
-         */
-        if (curr) {
-            /*
-                If the block represented by `curr` is bigger than
-                the requested value, size, it will be split,
-                so that `curr` ends up representing a block with a count of
-                size bytes.
-            
-                However, the split must also result in a second block
-                with enough space to hold a new header representing a block
-                of at least size 1.
-            
-                If the split were to occur such that there was not enough
-                room for a header with a block of at least size 1,
-                the block will not be split.
-            
-                `header_calculate_split_remainder_size(curr, size)` expands to:
-                `curr->m_size - size - sizeof(header_t)`
-            
-                So,
-                    the size of the block represented by `curr`
-                        minus
-                    the size requested for allocation by the client
-                        minus
-                    the size of `(header_t)` -- block metadata.
-            
-                must be greater than or equal to 1
-                to be worth a split.
-            
-                Basically, `curr->m_size` (the size of a candidate block)
-                must be at least (requested size + (`sizeof(header_t)` + 1))
-                in order to qualify for a split.
-            */
-            if (header_calculate_split_remainder_size(curr, size) >= 1) {
-                header_split_block(curr, size);
-            }
+    bool written = cgcs_profile_fputs(f);
+    long size = ftell(f);
 
-            // `curr` is now an occupied block.
-            header_toggle_use_status(curr);
+    if (fclose(f) != 0 || !written || size < 0 || rename(temp, path) != 0) {
+        fprintf(stderr, "[ERROR: cgcs_profile_start] Unable to write %s.\n", path);
+        remove(temp);
+        return;
+    }
 
-            /*
-                `ptr` is what will be returned from this function.
-                `curr` + 1 is assigned to `ptr`, because we do not want to return
-                the base address of the allocated block's header --
-                we want to return the base address of the allocated block itself.
+    profile.m_sizes[profile.m_next % CGCS_PROFILE_MAX_FILES] = (size_t)(size);
+    profile.m_bytes += (size_t)(size);
+    ++profile.m_next;
 
-                Therefore, we "skip" over the header (metadata) by moving
-                sizeof(header_t) bytes from address `curr`.
+    while (profile.m_oldest + 1 < profile.m_next
+           && (profile.m_bytes > profile.m_max_bytes || profile.m_next - profile.m_oldest > CGCS_PROFILE_MAX_FILES)) {
+        profile_path(path, sizeof path, profile.m_oldest);
+        remove(path);
 
-                Both
-                    ptr = curr + 1;
-                and
-                    ptr = (char *)(curr) + sizeof(header_t);
-                and
-                    ptr = (char *)(curr) + sizeof *curr;
-                are equivalent.
+        profile.m_bytes -= profile.m_sizes[profile.m_oldest % CGCS_PROFILE_MAX_FILES];
+        ++profile.m_oldest;
+    }
+}
 
-                `ptr` will now be the base address of the allocation requested by the caller.
-            */
-            ptr = curr + 1;
-        } else {
-            fprintf(stderr, 
-            "[ERROR: cgcs_malloc_impl] Unable to allocate %lu bytes. (header requires at least %lu bytes.)\n", 
-            size, sizeof *curr);
+/*!
+    \brief      Body of the heap profile writer thread; writes a snapshot
+                every `profile.m_interval_s` seconds until `cgcs_profile_stop`.
+
+    \param[in]  arg     unused
+
+    \return     `NULL`
+ */
+static void *profile_run(void *arg) {
+    pthread_mutex_lock(&profile.m_lock);
+
+    while (profile.m_running) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += profile.m_interval_s;
+
+        while (profile.m_running
+               && pthread_cond_timedwait(&profile.m_wakeup, &profile.m_lock, &deadline) == 0) {
+            // woken early; only `cgcs_profile_stop` signals
+        }
+
+        if (profile.m_running) {
+            profile_snapshot();
         }
     }
 
-    return ptr;
+    pthread_mutex_unlock(&profile.m_lock);
+    return NULL;
 }
 
 /*!
-    \brief      Frees the space pointer to by `ptr`, which must have been
-                returns by a previous call to `cgcs_malloc_impl`.
-  
-    \param[out]  ptr         address of the memory to free
-    \param[in]   filename    for use with the `__FILE__` directive
-    \param[in]   lineno      for use with the `__LINE__` directive
+    \brief      Starts an allocator-owned thread that writes a heap profile
+                (see `cgcs_profile_fputs`) to `dir` every `interval_s` seconds.
+
+    \details
+    Snapshots are named `cgcs_profile.<pid>.<n>.txt`. Once they add up to
+    more than `max_bytes`, or number more than `CGCS_PROFILE_MAX_FILES`,
+    the oldest are removed. Only one writer thread runs at a time.
+
+    \param[in]  dir         Existing directory for the snapshots
+    \param[in]  interval_s  Seconds between snapshots; at least 1
+    \param[in]  max_bytes   Most bytes of snapshots to keep
+
+    \return     `true` if the thread was started, `false` if it is already
+                running, `dir` is `NULL` or too long, or the thread could not be created.
  */
-void cgcs_free_impl(void *ptr, const char *filename, size_t lineno) {
-    /*
-        Sanity check:
-            Is `ptr` outside the range of [&ptr, ptr + CGCS_MALLOC_BLOCK_SIZE) ?
-            If so, `return`.
-     */
-    if (pointer_outside_block_range(ptr)) {
-        fprintf(stderr, "[ERROR: cgcs_free_impl] A free was attempted on a pointer that does not refer to a valid allocation by cgcs_malloc_impl.\n");
-        return;
+bool cgcs_profile_start(const char *dir, unsigned interval_s, size_t max_bytes) {
+    if (!dir) {
+        fprintf(stderr, "[ERROR: cgcs_profile_start] No directory was given for the snapshots.\n");
+        return false;
     }
 
-    /*
-        `ptr` is the address of the allocation that proceeds its header.
-        To get to the header (and determine its occupancy status/`m_size` value),
-        we type-coerce `ptr` as `(header_t *)`, and decrement the type-coerced address by 1.
-     */
-    header_t *curr = (header_t *)(ptr) - 1;
-    
-    if (header_is_used(curr)) {
-        // `curr` will now represent an unoccupied block.
-        // The proceeding block is now free for use.
-        header_toggle_use_status(curr);
+    bool started = false;
 
-        /*
-            Now that `curr` is marked as free,
-            if `header_next(curr)` is also free,
-            we can merge (coalesce) them.
-         */
-        header_t *next = header_is_last(curr) ? NULL : header_next(curr);
+    pthread_mutex_lock(&profile.m_lock);
 
-        if (next && header_is_free(next)) {
-            header_merge_with_next_block(curr);
-        }
+    if (!profile.m_running && strlen(dir) < sizeof profile.m_dir) {
+        strcpy(profile.m_dir, dir);
 
-        // The entirety of `block` will also be searched for
-        // adjacent free blocks to coalesce (combine).
-        header_coalesce((header_t *)(block));
-    } else {
-        /*
-            If `curr` reports that this block of memory
-            is already free, there is nothing left to do but
-            report the findings to the user -- return afterward.
-         */
-        fprintf(stderr, 
-        "[ERROR: cgcs_free_impl] Cannot release memory for inactive storage -- did you already call free on this address?\n");        
+        profile.m_running = true;
+        profile.m_interval_s = interval_s > 0 ? interval_s : 1;
+        profile.m_max_bytes = max_bytes;
+        profile.m_bytes = 0;
+        profile.m_oldest = profile.m_next;
+
+        started = pthread_create(&profile.m_thread, NULL, profile_run, NULL) == 0;
+        profile.m_running = started;
+    }
+
+    pthread_mutex_unlock(&profile.m_lock);
+
+    if (!started) {
+        fprintf(stderr, "[ERROR: cgcs_profile_start] Profile writer is already running or could not be created.\n");
+    }
+
+    return started;
+}
+
+/*!
+    \brief      Stops and joins the heap profile writer thread, if it is running.
+                The snapshots already written are left in place.
+ */
+void cgcs_profile_stop() {
+    pthread_mutex_lock(&profile.m_lock);
+
+    if (!profile.m_running) {
+        pthread_mutex_unlock(&profile.m_lock);
+        return;
     }
+
+    profile.m_running = false;
+    pthread_cond_signal(&profile.m_wakeup);
+    pthread_mutex_unlock(&profile.m_lock);
+
+    pthread_join(profile.m_thread, NULL);
 }
 
 // Color macros
@@ -627,14 +3878,14 @@ void cgcs_free_impl(void *ptr, const char *filename, size_t lineno) {
 
 #define HEADER_FPUTS_STATS \
 "------------------------------------------\n"\
-"Used blocks in list:\t%s%u%s blocks\n"\
-"Free blocks in list:\t%s%u%s blocks\n\n"\
-"Free space:\t\t%s%u%s of %s%u%s bytes\n"\
-"Available for client:\t%s%u%s of %s%u%s bytes\n\n"\
-"Total data in use:\t%s%u%s of %s%u%s bytes\n"\
-"Client data in use:\t%s%u%s of %s%u%s bytes\n\n"\
-"Largest used block:\t%s%u%s of %s%u%s bytes\n"\
-"Largest free block:\t%s%u%s of %s%u%s bytes\n\n"\
+"Used blocks in list:\t%s%lu%s blocks\n"\
+"Free blocks in list:\t%s%lu%s blocks\n\n"\
+"Free space:\t\t%s%lu%s of %s%lu%s bytes\n"\
+"Available for client:\t%s%lu%s of %s%lu%s bytes\n\n"\
+"Total data in use:\t%s%lu%s of %s%lu%s bytes\n"\
+"Client data in use:\t%s%lu%s of %s%lu%s bytes\n\n"\
+"Largest used block:\t%s%lu%s of %s%lu%s bytes\n"\
+"Largest free block:\t%s%lu%s of %s%lu%s bytes\n\n"\
 "Size of metadata:\t%s%lu%s bytes\n\n"\
 "[%s:%lu] %s%s%s\n%s%s %s%s\n"\
 "------------------------------------------\n\n"\
@@ -649,65 +3900,83 @@ void cgcs_free_impl(void *ptr, const char *filename, size_t lineno) {
  */
 void header_fputs(FILE *dest, const char *filename, const char *funcname, size_t lineno) {
     struct {
-        uint16_t block_used;
-        uint16_t block_free;
+        unsigned long block_used;
+        unsigned long block_free;
 
-        uint16_t space_used;
-        uint16_t space_free;
+        unsigned long space_used;
+        unsigned long space_free;
 
-        uint16_t bytes_in_use;
-        uint16_t block_count_available;
+        unsigned long bytes_in_use;
+        unsigned long block_count_available;
 
-        uint16_t largest_block_used;
-        uint16_t largest_block_free;
+        unsigned long largest_block_used;
+        unsigned long largest_block_free;
     } info = { 0, 0, 0, 0, 0, 0, 0, 0 };
 
-    header_t *h = (header_t *)(block);
+    size_t capacity = 0;
+    size_t length = 0;
+    cgcs_header_size_t *sizes = mem_snapshot_map(&capacity, &length);
+
+    if (!sizes) {
+        fprintf(stderr, "[ERROR: header_fputs] Unable to map %lu bytes for the block list.\n", (unsigned long)(length));
+        return;
+    }
+
+    // The block list is copied by `mem_snapshot`; nothing is held while it is printed.
+    cgcs_heap_summary_t summary;
+    size_t count = mem_snapshot(&summary, sizes, capacity);
+    char *base = __atomic_load_n(&block.m_base, __ATOMIC_RELAXED);
+
+    if (count == 0) {
+        munmap(sizes, length);
 
-    if (h->m_size == 0) {
         fprintf(dest, HEADER_FPUTS_NO_ALLOCS_MADE, 
         filename, lineno, KCYN, funcname, KNRM, KGRY, __DATE__, __TIME__, KNRM);
         return;
     }
 
+    count = count > capacity ? capacity : count;
+
     fprintf(dest, HEADER_FPUTS_COLUMNS, KWHT_b, KNRM, KWHT_b, KNRM, KWHT_b, KNRM);
 
-    while (h) {
-        bool header_free = header_is_free(h);
+    for (size_t i = 0, offset = 0; i < count; ++i) {
+        bool header_free = sizes[i] > 0;
+        cgcs_header_size_t size = header_free ? sizes[i] : -sizes[i];
+
+        fprintf(dest, "%s%p%s\t%s\t\t%d\n", 
+        KGRY, (void *)(base + offset + sizeof(header_t)), KNRM, header_free ? KGRN"free"KNRM : KRED_b"in use"KNRM, size);
 
-        info.block_used += header_free ? 0 : 1;
-        info.block_free += header_free ? 1 : 0;
+        if (!header_free && info.largest_block_used < (unsigned long)(size)) {
+            info.largest_block_used = (unsigned long)(size);
+        }
 
-        info.space_used += header_free ? 0 : header_alloc_size(h);
-        info.space_free += header_free ? header_alloc_size(h) : 0;
+        offset += sizeof(header_t) + (size_t)(size);
+    }
 
-        info.largest_block_used =
-            (info.largest_block_used < header_alloc_size(h)) && !header_free ?
-                header_alloc_size(h) :
-                info.largest_block_used;
+    munmap(sizes, length);
 
-        info.largest_block_free = (info.largest_block_free < header_alloc_size(h) && header_free ?
-                                       header_alloc_size(h) :
-                                       info.largest_block_free);
+    info.block_used = (unsigned long)(summary.m_used_blocks);
+    info.block_free = (unsigned long)(summary.m_free_blocks);
 
-        fprintf(dest, "%s%p%s\t%s\t\t%d\n", 
-        KGRY, (void *)(h + 1), KNRM, header_free ? KGRN"free"KNRM : KRED_b"in use"KNRM, header_alloc_size(h));
+    info.space_used = (unsigned long)(summary.m_used_bytes);
+    info.space_free = (unsigned long)(summary.m_free_bytes);
 
-        h = header_is_last(h) ? NULL : header_next(h);
-    }
+    info.largest_block_free = (unsigned long)(summary.m_largest_free);
 
     info.bytes_in_use =
-        info.space_used + (sizeof *h * (info.block_used + info.block_free));
+        info.space_used + (sizeof(header_t) * (info.block_used + info.block_free));
 
     info.block_count_available =
-        CGCS_MALLOC_BLOCK_SIZE - (sizeof *h * (info.block_free + info.block_used));
+        summary.m_committed - (sizeof(header_t) * (info.block_free + info.block_used));
+
+    unsigned long committed = (unsigned long)(summary.m_committed);
 
     fprintf(dest, HEADER_FPUTS_STATS, 
         KWHT_b, info.block_used, KNRM,
         KWHT_b, info.block_free, KNRM,
-        KWHT_b, info.space_free, KNRM, KWHT_b, CGCS_MALLOC_BLOCK_SIZE, KNRM,
+        KWHT_b, info.space_free, KNRM, KWHT_b, committed, KNRM,
         KWHT_b, info.space_free, KNRM, KWHT_b, info.block_count_available, KNRM,
-        KWHT_b, info.bytes_in_use, KNRM, KWHT_b, CGCS_MALLOC_BLOCK_SIZE, KNRM,
+        KWHT_b, info.bytes_in_use, KNRM, KWHT_b, committed, KNRM,
         KWHT_b, info.space_used, KNRM, KWHT_b, info.block_count_available, KNRM,
         KWHT_b, info.largest_block_used, KNRM, KWHT_b, info.block_count_available, KNRM,
         KWHT_b, info.largest_block_free, KNRM, KWHT_b, info.block_count_available, KNRM,
@@ -11,37 +11,585 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 
+/*!
+    \typedef    cgcs_header_size_t
+    \brief      Type of the size field that precedes every allocation
+
+    \details
+    Mirrors the last field of `struct header` in cgcs_malloc.c, which sits
+    right before every allocation, so that the inline fast path below
+    can read the size of a block without a call.
+    A negative value means the block is in use.
+ */
+typedef int32_t cgcs_header_size_t;
+
+/*!
+    \def        CGCS_MALLOC_ALIGNMENT
+    \brief      Alignment of every address returned by the allocation functions
+
+    \details
+    Also the size of the header before every block within the heap,
+    and the granularity of block sizes, so that every block starts aligned.
+ */
+#define CGCS_MALLOC_ALIGNMENT       _Alignof(max_align_t)
+
+/*!
+    \def        CGCS_TCACHE_CLASS_COUNT
+    \brief      Number of small size classes kept in the per-thread cache
+
+    \details
+    Class `i` holds blocks of at least `CGCS_TCACHE_CLASS_SIZE(i)` bytes;
+    the classes are 16, 32, 64 and 128 bytes, multiples of `CGCS_MALLOC_ALIGNMENT`.
+ */
+#define CGCS_TCACHE_CLASS_COUNT     4
+#define CGCS_TCACHE_CLASS_CAPACITY  32  //!< most cached blocks per class, per thread
+#define CGCS_TCACHE_GROW_MISSES     8   //!< misses in a class before its limit grows
+#define CGCS_TCACHE_ADAPT_PERIOD    256 //!< frees between checks for idle cached blocks; a power of two
+#define CGCS_TCACHE_CLASS_SIZE(i)   ((size_t)(16) << (i))
+#define CGCS_TCACHE_MAX_SIZE        CGCS_TCACHE_CLASS_SIZE(CGCS_TCACHE_CLASS_COUNT - 1)
+
+/*!
+    \def        CGCS_MALLOC_LARGE_SIZE
+    \brief      Smallest request served by a mapping of its own, outside of the heap,
+                when the page provider can map (`m_map`)
+ */
+#define CGCS_MALLOC_LARGE_SIZE      ((size_t)(1) << 20)
+
+/*!
+    \typedef    cgcs_tcache_t
+    \brief      Per-thread cache of recently freed small blocks
+
+    \details
+    Cached blocks stay marked as in use within the allocator,
+    so they are never coalesced while they sit in the cache.
+
+    Each class starts out with no capacity. A class that keeps missing
+    grows (`cgcs_tcache_grow`); a class whose blocks sit unused for
+    `CGCS_TCACHE_ADAPT_PERIOD` frees shrinks (`cgcs_tcache_adapt`).
+    A cache that the maintenance thread finds untouched for its decay time
+    is flushed by the maintenance thread and loses its share of the global
+    budget at once; its thread drops its limits (`cgcs_tcache_drain`)
+    when it next uses the cache.
+
+    The thread sets `m_busy` around each push and pop, and leaves the cache
+    alone while `m_claimed` is set; the maintenance thread sets `m_claimed`,
+    runs a process-wide memory barrier (`membarrier`), and only flushes
+    the cache if `m_busy` is still clear. The push and pop fast paths
+    thus need no fence of their own.
+ */
+typedef struct cgcs_tcache {
+    void *m_slots[CGCS_TCACHE_CLASS_COUNT][CGCS_TCACHE_CLASS_CAPACITY];
+    uint8_t m_count[CGCS_TCACHE_CLASS_COUNT];
+    uint8_t m_limit[CGCS_TCACHE_CLASS_COUNT];   //! current capacity of each class
+    uint8_t m_low[CGCS_TCACHE_CLASS_COUNT];     //! lowest `m_count` since the last adaptation
+    uint8_t m_misses[CGCS_TCACHE_CLASS_COUNT];  //! misses since the class last grew
+    uint16_t m_frees;           //! frees seen by the cache, modulo `CGCS_TCACHE_ADAPT_PERIOD`
+    atomic_uint m_epoch;        //! `cgcs_tcache_epoch` as of the last drain; made stale to force one
+    atomic_uint m_active;       //! `cgcs_tcache_clock` as of the last push or pop
+    atomic_size_t m_budget;     //! bytes of the global budget that `m_limit` accounts for
+    atomic_bool m_busy;         //! set by the thread during a push or pop
+    atomic_bool m_claimed;      //! set while the maintenance thread may be flushing the cache
+    struct cgcs_tcache *m_next; //! next registered cache; guarded by the registry's lock
+    bool m_registered;          //! set once the cache is known to the maintenance thread and thread exit
+    bool m_retired;             //! set once the thread has exited; the cache no longer grows
+} cgcs_tcache_t;
+
+extern _Thread_local cgcs_tcache_t cgcs_tcache;
+
+/*
+    Upper bound on every thread's per-class limit, within [0, `CGCS_TCACHE_CLASS_CAPACITY`];
+    lowered by the maintenance thread under memory pressure.
+ */
+extern atomic_uint_least8_t cgcs_tcache_limit;
+
+/*
+    Raised by the maintenance thread when memory pressure rises;
+    every thread drains its cache on its next push or pop after a change.
+ */
+extern atomic_uint cgcs_tcache_epoch;
+
+/*
+    Milliseconds of `CLOCK_MONOTONIC`, as of the maintenance thread's last wakeup;
+    stamped into `m_active` by every push and pop.
+ */
+extern atomic_uint cgcs_tcache_clock;
+
+/*!
+    \def        CGCS_STATS_CLASS_COUNT
+    \brief      Number of request size classes counted by `cgcs_stats_t`
+
+    \details
+    Class 0 counts requests of up to 8 bytes, class `i` requests of
+    up to `8 << i` bytes; the last class also counts anything larger.
+ */
+#define CGCS_STATS_CLASS_COUNT  28
+
+/*!
+    \typedef    cgcs_stats_t
+    \brief      Allocation counters, summed over every thread by `cgcs_stats_read`
+
+    \details
+    Byte counts are usable sizes, as reserved by the allocator;
+    `m_bytes_allocated - m_bytes_freed` is the number of bytes in use.
+    Blocks held by a thread's cache count as freed.
+ */
+typedef struct cgcs_stats {
+    uint64_t m_mallocs;
+    uint64_t m_frees;
+    uint64_t m_bytes_allocated;
+    uint64_t m_bytes_freed;
+    uint64_t m_class_mallocs[CGCS_STATS_CLASS_COUNT];
+} cgcs_stats_t;
+
+/*!
+    \typedef    cgcs_stats_slot_t
+    \brief      One thread's allocation counters
+
+    \details
+    Only the owning thread writes to its slot, with relaxed loads and stores
+    rather than read-modify-write operations; readers sum every registered slot.
+    Slots are aligned to a cache line, so that no two threads' counters share one.
+
+    Every update is bracketed by `cgcs_stats_write_begin` and `cgcs_stats_write_end`,
+    a sequence lock: a reader retries its copy of a slot until `m_sequence`
+    was even and unchanged across it, so related counters are never torn apart.
+ */
+typedef struct cgcs_stats_slot {
+    _Alignas(64) atomic_uint m_sequence;    //! odd while the owner is updating the counters
+    atomic_uint_least64_t m_mallocs;
+    atomic_uint_least64_t m_frees;
+    atomic_uint_least64_t m_bytes_allocated;
+    atomic_uint_least64_t m_bytes_freed;
+    atomic_uint_least64_t m_class_mallocs[CGCS_STATS_CLASS_COUNT];
+    struct cgcs_stats_slot *m_next; //! next registered slot; guarded by the registry's lock
+    bool m_registered;              //! set once the slot is visible to `cgcs_stats_read`
+    bool m_retired;                 //! set once the thread has exited; counts go to the registry instead
+} cgcs_stats_slot_t;
+
+extern _Thread_local cgcs_stats_slot_t cgcs_stats_slot;
+
+/*!
+    \typedef    cgcs_heap_summary_t
+    \brief      Totals of the blocks within the heap, from `cgcs_heap_summary`
+ */
+typedef struct cgcs_heap_summary {
+    uint64_t m_committed;       //! committed bytes, headers included
+    uint64_t m_used_blocks;
+    uint64_t m_used_bytes;      //! usable bytes of in-use blocks (thread caches included)
+    uint64_t m_free_blocks;
+    uint64_t m_free_bytes;
+    uint64_t m_largest_free;    //! usable bytes of the largest free block
+    uint64_t m_large_count;     //! number of live large allocations
+    uint64_t m_large_bytes;     //! length of the mappings of live large allocations
+    uint64_t m_large_cached;    //! length of freed large mappings kept for reuse
+} cgcs_heap_summary_t;
+
+/*!
+    \typedef    cgcs_page_provider_t
+    \brief      Where the heap gets its memory from
+
+    \details
+    The heap reserves one contiguous range with `m_reserve` and commits it
+    front to back with `m_commit` as it grows. `m_purge` drops the contents
+    of free pages, `m_release` gives back the reservation. Large requests get
+    mappings of their own from `m_map` and `m_unmap`; a provider without them
+    serves large requests from its range, like any other.
+
+    `m_reserve` and `m_commit` are required, every other operation may be `NULL`.
+    The remaining fields hold the state of the built-in providers; a custom
+    provider may use them, or embed `cgcs_page_provider_t` as the first member
+    of a struct of its own and cast `self` back.
+ */
+typedef struct cgcs_page_provider {
+    const char *m_name;
+
+    //! reserves up to `*length` bytes, aligned to `CGCS_MALLOC_ALIGNMENT`; stores the bytes reserved to `*length`. `NULL` on failure.
+    void *(*m_reserve)(const struct cgcs_page_provider *self, size_t *length);
+    //! makes reserved bytes readable and writable
+    bool (*m_commit)(const struct cgcs_page_provider *self, void *address, size_t length);
+    //! lets committed bytes go, keeping them committed; they read as anything on next use
+    void (*m_purge)(const struct cgcs_page_provider *self, void *address, size_t length);
+    //! gives back a reservation
+    void (*m_release)(const struct cgcs_page_provider *self, void *address, size_t length);
+    //! maps `length` readable and writable bytes, aligned to a page, for a large request. `NULL` on failure.
+    void *(*m_map)(const struct cgcs_page_provider *self, size_t length);
+    //! unmaps what `m_map` mapped
+    void (*m_unmap)(const struct cgcs_page_provider *self, void *address, size_t length);
+
+    void *m_buffer;     //! caller's buffer (static)
+    size_t m_length;    //! length of `m_buffer` (static), or huge page size (hugetlb)
+    int m_fd;           //! backing file descriptor (memfd, file), or -1
+} cgcs_page_provider_t;
+
+/*!
+    \typedef    cgcs_arena_t
+    \brief      An independent heap within memory the caller owns
+ */
+typedef struct cgcs_arena cgcs_arena_t;
+
+/*!
+    \typedef    cgcs_pool_t
+    \brief      A preallocated set of equally sized slots
+ */
+typedef struct cgcs_pool cgcs_pool_t;
+
 // `cgcs_malloc/cgcs_free`: proxy functions designed for use by client
 static void *cgcs_malloc(size_t size);
 static void cgcs_free(void *ptr);
+static size_t cgcs_good_size(size_t size);
 
 // `cgcs_malloc_impl`: memory allocator functions, allocate and free
 void *cgcs_malloc_impl(size_t size, const char *filename, size_t lineno);
 void cgcs_free_impl(void *ptr, const char *filename, size_t lineno);
 
+// `cgcs_malloc_multi`: allocates several objects, each individually freeable, in one contiguous region
+bool cgcs_malloc_multi(const size_t *sizes, size_t count, void **out);
+
+// `cgcs_good_size_impl`: usable size reserved for a request, before per-thread cache rounding
+size_t cgcs_good_size_impl(size_t size);
+
+// `cgcs_try_expand`: grows an allocation in place, or fails without moving it
+size_t cgcs_try_expand(void *ptr, size_t min_size, size_t preferred_size);
+
+// `cgcs_maintenance_start/stop`: optional background thread for deferred coalescing and purging
+bool cgcs_maintenance_start(unsigned interval_ms, unsigned decay_ms);
+void cgcs_maintenance_stop(void);
+
+// `cgcs_stack_alloc/free`: cached, guarded stacks for fibers and green threads
+void *cgcs_stack_alloc(size_t size);
+void cgcs_stack_free(void *stack, size_t size);
+
+// `cgcs_profile_*`: heap profile snapshots, on demand or from an optional writer thread
+bool cgcs_profile_fputs(FILE *dest);
+bool cgcs_profile_start(const char *dir, unsigned interval_s, size_t max_bytes);
+void cgcs_profile_stop(void);
+
+// `cgcs_page_provider_*`: the heap's source of memory; set it before the first allocation
+bool cgcs_page_provider_set(const cgcs_page_provider_t *provider);
+void cgcs_page_provider_mmap(cgcs_page_provider_t *provider);
+bool cgcs_page_provider_static(cgcs_page_provider_t *provider, void *buffer, size_t length);
+bool cgcs_page_provider_hugetlb(cgcs_page_provider_t *provider);
+bool cgcs_page_provider_memfd(cgcs_page_provider_t *provider, const char *name);
+bool cgcs_page_provider_file(cgcs_page_provider_t *provider, const char *path);
+
+// `cgcs_arena_*`: independent heaps within caller-supplied buffers; not for `cgcs_free`
+cgcs_arena_t *cgcs_arena_create_in(void *buffer, size_t length);
+void *cgcs_arena_alloc(cgcs_arena_t *arena, size_t size);
+void cgcs_arena_free(cgcs_arena_t *arena, void *ptr);
+void cgcs_arena_destroy(cgcs_arena_t *arena);
+
+// `cgcs_pool_*`: fixed-size objects with constant-time allocation and release; not for `cgcs_free`
+cgcs_pool_t *cgcs_pool_create(size_t object_size, size_t count);
+void *cgcs_pool_alloc(cgcs_pool_t *pool);
+void cgcs_pool_free(cgcs_pool_t *pool, void *ptr);
+void cgcs_pool_destroy(cgcs_pool_t *pool);
+
+// `cgcs_stats_read`: sums the allocation counters of every thread
+void cgcs_stats_read(cgcs_stats_t *stats);
+void cgcs_heap_summary(cgcs_heap_summary_t *summary);
+bool cgcs_stats_register(void);
+void cgcs_stats_fold(const cgcs_stats_t *counts);
+
+// `cgcs_tcache_*`: out-of-line support for the per-thread cache
+void cgcs_tcache_register(void);
+void cgcs_tcache_flush(void);
+void cgcs_tcache_drain(void);
+void cgcs_tcache_grow(size_t index);
+void cgcs_tcache_adapt(void);
+
+/*!
+    \brief      Adds `delta` to one of the calling thread's counters.
+
+    \details    A plain load and store: only the owning thread writes the counter.
+                Unsigned wrap-around makes `(uint64_t)(-n)` subtract `n`.
+ */
+static inline void cgcs_stats_add(atomic_uint_least64_t *counter, uint64_t delta) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + delta, memory_order_relaxed);
+}
+
+/*!
+    \brief      Opens an update of the calling thread's counters;
+                `m_sequence` becomes odd.
+ */
+static inline void cgcs_stats_write_begin(void) {
+    atomic_store_explicit(&cgcs_stats_slot.m_sequence,
+                          atomic_load_explicit(&cgcs_stats_slot.m_sequence, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+/*!
+    \brief      Closes an update of the calling thread's counters;
+                `m_sequence` becomes even.
+ */
+static inline void cgcs_stats_write_end(void) {
+    atomic_store_explicit(&cgcs_stats_slot.m_sequence,
+                          atomic_load_explicit(&cgcs_stats_slot.m_sequence, memory_order_relaxed) + 1,
+                          memory_order_release);
+}
+
+/*!
+    \brief      Returns the `cgcs_stats_t` class of a request of `size` bytes.
+ */
+static inline size_t cgcs_stats_class_index(size_t size) {
+    if (size <= 8) {
+        return 0;
+    }
+
+    size_t i = (size_t)(63 - __builtin_clzll((unsigned long long)(size - 1))) - 2;
+    return i < CGCS_STATS_CLASS_COUNT ? i : CGCS_STATS_CLASS_COUNT - 1;
+}
+
+/*!
+    \brief      Counts an allocation of `bytes` usable bytes
+                for a request of `size` bytes.
+ */
+static inline void cgcs_stats_count_malloc(size_t size, size_t bytes) {
+    if (!cgcs_stats_slot.m_registered && !cgcs_stats_register()) {
+        cgcs_stats_t counts = { .m_mallocs = 1, .m_bytes_allocated = bytes };
+        counts.m_class_mallocs[cgcs_stats_class_index(size)] = 1;
+        cgcs_stats_fold(&counts);
+        return;
+    }
+
+    cgcs_stats_write_begin();
+    cgcs_stats_add(&cgcs_stats_slot.m_mallocs, 1);
+    cgcs_stats_add(&cgcs_stats_slot.m_bytes_allocated, bytes);
+    cgcs_stats_add(&cgcs_stats_slot.m_class_mallocs[cgcs_stats_class_index(size)], 1);
+    cgcs_stats_write_end();
+}
+
+/*!
+    \brief      Counts the release of an allocation of `bytes` usable bytes.
+ */
+static inline void cgcs_stats_count_free(size_t bytes) {
+    if (!cgcs_stats_slot.m_registered && !cgcs_stats_register()) {
+        cgcs_stats_t counts = { .m_frees = 1, .m_bytes_freed = bytes };
+        cgcs_stats_fold(&counts);
+        return;
+    }
+
+    cgcs_stats_write_begin();
+    cgcs_stats_add(&cgcs_stats_slot.m_frees, 1);
+    cgcs_stats_add(&cgcs_stats_slot.m_bytes_freed, bytes);
+    cgcs_stats_write_end();
+}
+
+/*!
+    \brief      Returns the smallest cache class that fits `size` bytes.
+
+    \param[in]  size    Requested size, within [1, `CGCS_TCACHE_MAX_SIZE`]
+
+    \return     index of the class, within [0, `CGCS_TCACHE_CLASS_COUNT`)
+ */
+static inline size_t cgcs_tcache_class_index(size_t size) {
+    size_t i = 0;
+
+    while (CGCS_TCACHE_CLASS_SIZE(i) < size) {
+        ++i;
+    }
+
+    return i;
+}
+
+/*!
+    \brief      Starts a push or pop: drains the calling thread's cache
+                if it was told to, and records that the thread is using it.
+
+    \return     `true` if the cache may be used until `cgcs_tcache_leave`,
+                `false` while the maintenance thread is flushing it.
+ */
+static inline bool cgcs_tcache_enter(void) {
+    atomic_store_explicit(&cgcs_tcache.m_busy, true, memory_order_relaxed);
+
+    // The maintenance thread's `membarrier` orders the store above before the loads below.
+    atomic_signal_fence(memory_order_seq_cst);
+
+    if (atomic_load_explicit(&cgcs_tcache.m_epoch, memory_order_relaxed)
+    != atomic_load_explicit(&cgcs_tcache_epoch, memory_order_relaxed)) {
+        if (atomic_load_explicit(&cgcs_tcache.m_claimed, memory_order_acquire)) {
+            atomic_store_explicit(&cgcs_tcache.m_busy, false, memory_order_release);
+            return false;
+        }
+
+        cgcs_tcache_drain();
+    }
+
+    atomic_store_explicit(&cgcs_tcache.m_active,
+                          atomic_load_explicit(&cgcs_tcache_clock, memory_order_relaxed), memory_order_relaxed);
+    return true;
+}
+
+/*!
+    \brief      Ends a push or pop started by `cgcs_tcache_enter`.
+ */
+static inline void cgcs_tcache_leave(void) {
+    atomic_signal_fence(memory_order_seq_cst);
+    atomic_store_explicit(&cgcs_tcache.m_busy, false, memory_order_release);
+}
+
+/*!
+    \brief      Pops a cached block for a request of `size` bytes.
+
+    \param[in]  size    Requested size, within [1, `CGCS_TCACHE_MAX_SIZE`]
+
+    \return     a cached block of at least `size` bytes,
+                or `NULL` if the class is empty.
+ */
+static inline void *cgcs_tcache_pop(size_t size) {
+    if (!cgcs_tcache_enter()) {
+        return NULL;
+    }
+
+    size_t i = cgcs_tcache_class_index(size);
+    void *ptr = NULL;
+
+    if (cgcs_tcache.m_count[i] == 0) {
+        if (++cgcs_tcache.m_misses[i] >= CGCS_TCACHE_GROW_MISSES) {
+            cgcs_tcache_grow(i);
+        }
+    } else {
+        ptr = cgcs_tcache.m_slots[i][--cgcs_tcache.m_count[i]];
+
+        if (cgcs_tcache.m_count[i] < cgcs_tcache.m_low[i]) {
+            cgcs_tcache.m_low[i] = cgcs_tcache.m_count[i];
+        }
+    }
+
+    cgcs_tcache_leave();
+    return ptr;
+}
+
+/*!
+    \brief      Pushes a small in-use block onto this thread's cache.
+
+    \details    The block goes to the largest class it can satisfy.
+                Blocks outside of the cached range, or blocks whose
+                class is already at its limit, are left to the caller.
+
+    \param[in]  ptr     Address returned by `cgcs_malloc`
+
+    \return     `true` if the block was cached, `false` otherwise.
+ */
+static inline bool cgcs_tcache_push(void *ptr) {
+    cgcs_header_size_t size = -((const cgcs_header_size_t *)(ptr))[-1];
+
+    // A block keeps up to a header's worth of slack when its remainder is too small to split off.
+    if (size < (cgcs_header_size_t)(CGCS_TCACHE_CLASS_SIZE(0))
+    || size > (cgcs_header_size_t)(CGCS_TCACHE_MAX_SIZE + CGCS_MALLOC_ALIGNMENT)) {
+        return false;
+    }
+
+    if (!cgcs_tcache_enter()) {
+        return false;
+    }
+
+    size_t i = 0;
+
+    while (i + 1 < CGCS_TCACHE_CLASS_COUNT && CGCS_TCACHE_CLASS_SIZE(i + 1) <= (size_t)(size)) {
+        ++i;
+    }
+
+    if (++cgcs_tcache.m_frees % CGCS_TCACHE_ADAPT_PERIOD == 0) {
+        cgcs_tcache_adapt();
+    }
+
+    bool cached = cgcs_tcache.m_count[i] < cgcs_tcache.m_limit[i]
+               && cgcs_tcache.m_count[i] < atomic_load_explicit(&cgcs_tcache_limit, memory_order_relaxed);
+
+    if (cached) {
+        cgcs_tcache.m_slots[i][cgcs_tcache.m_count[i]++] = ptr;
+    }
+
+    cgcs_tcache_leave();
+
+    if (cached) {
+        cgcs_stats_count_free((size_t)(size));
+    }
+
+    return cached;
+}
+
 /*!
     \brief      Proxy inline function;
                 calls `cgcs_malloc_impl` with `__FILE__` and `__LINE__` macros
 
+    \details    Requests of up to `CGCS_TCACHE_MAX_SIZE` bytes are served
+                from the calling thread's cache when it has a block of that class;
+                only a miss calls `cgcs_malloc_impl`, rounded up to the class size.
+                `#define CGCS_MALLOC_NO_TCACHE` before `#include "cgcs_malloc.h"`
+                to always call `cgcs_malloc_impl`.
+
     \param[in]  size    Desired size for memory allocation
 
     \return     address of allocated memory from `cgcs_malloc_impl`;
                 will be `NULL` if `cgcs_malloc_impl` failed.
  */
 static inline void *cgcs_malloc(size_t size) {
+#ifndef CGCS_MALLOC_NO_TCACHE
+    if (size - 1 < CGCS_TCACHE_MAX_SIZE) {
+        void *ptr = cgcs_tcache_pop(size);
+
+        if (ptr) {
+            cgcs_stats_count_malloc(size, (size_t)(-((const cgcs_header_size_t *)(ptr))[-1]));
+            return ptr;
+        }
+
+        size = CGCS_TCACHE_CLASS_SIZE(cgcs_tcache_class_index(size));
+    }
+#endif /* CGCS_MALLOC_NO_TCACHE */
+
     return cgcs_malloc_impl(size, __FILE__, __LINE__);
 }
 
+/*!
+    \brief      Returns the usable size that `cgcs_malloc(size)` would reserve.
+
+    \details    Requests are rounded up to a per-thread cache class,
+                to a multiple of the header size, or to the capacity of
+                a large mapping. A dynamic array or string buffer can
+                allocate `cgcs_good_size(n)` bytes instead of `n`,
+                and use all of them without a later reallocation.
+
+    \param[in]  size    Requested size, in bytes
+
+    \return     a size of at least `size` bytes, or 0 if `size` is 0
+                or cannot be allocated.
+ */
+static inline size_t cgcs_good_size(size_t size) {
+#ifndef CGCS_MALLOC_NO_TCACHE
+    if (size - 1 < CGCS_TCACHE_MAX_SIZE) {
+        return CGCS_TCACHE_CLASS_SIZE(cgcs_tcache_class_index(size));
+    }
+#endif /* CGCS_MALLOC_NO_TCACHE */
+
+    return cgcs_good_size_impl(size);
+}
+
 /*!
     \brief      Proxy inline function;
                 calls `cgcs_free_impl` with `__FILE__` and `__LINE__` macros
 
+    \details    Small blocks are pushed onto the calling thread's cache instead.
+                The cache path does not check `ptr` for validity --
+                a pointer that did not come from `cgcs_malloc`, or a double free,
+                is only diagnosed with `CGCS_MALLOC_NO_TCACHE`.
+
     \param[in]  ptr     Pointer to memory resources that will be freed
  */
 static inline void cgcs_free(void *ptr) {
+#ifndef CGCS_MALLOC_NO_TCACHE
+    if (ptr && cgcs_tcache_push(ptr)) {
+        return;
+    }
+#endif /* CGCS_MALLOC_NO_TCACHE */
+
     cgcs_free_impl(ptr, __FILE__, __LINE__);
 }
 
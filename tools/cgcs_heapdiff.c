@@ -0,0 +1,187 @@
+/*!
+    \file       cgcs_heapdiff.c
+    \brief      Compares two cgcs heap profiles
+
+    \details
+    Usage: cgcs_heapdiff <before profile> <after profile>
+
+    Reports what changed between two profiles written by `cgcs_profile_fputs`
+    (or by the `cgcs_profile_start` writer thread): the totals, the allocations
+    by request size class, and histograms of used and free blocks by size.
+    Steady growth of used blocks within one size range points at a leak;
+    free bytes growing faster than the largest free block point at fragmentation.
+
+    \author     Gemuele Aludino
+    \date       18 Oct 2026
+ */
+
+#include "cgcs_profile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*!
+    \typedef    heapdiff_summary_t
+    \brief      Totals and size histograms of the blocks of one profile
+ */
+typedef struct heapdiff_summary {
+    uint64_t m_used_blocks;
+    uint64_t m_used_bytes;
+    uint64_t m_free_blocks;
+    uint64_t m_free_bytes;
+    uint64_t m_largest_free;
+
+    uint64_t m_used_count[CGCS_PROFILE_CLASS_COUNT];
+    uint64_t m_used_size[CGCS_PROFILE_CLASS_COUNT];
+    uint64_t m_free_count[CGCS_PROFILE_CLASS_COUNT];
+    uint64_t m_free_size[CGCS_PROFILE_CLASS_COUNT];
+} heapdiff_summary_t;
+
+/*!
+    \brief      Summarizes the blocks of `profile`.
+ */
+static heapdiff_summary_t heapdiff_summarize(const cgcs_profile_t *profile) {
+    heapdiff_summary_t self = { 0 };
+
+    for (size_t i = 0; i < profile->m_block_count; ++i) {
+        const cgcs_profile_block_t *block = &profile->m_blocks[i];
+        size_t c = cgcs_profile_class_index(block->m_size);
+
+        if (block->m_used) {
+            ++self.m_used_blocks;
+            self.m_used_bytes += block->m_size;
+            ++self.m_used_count[c];
+            self.m_used_size[c] += block->m_size;
+        } else {
+            ++self.m_free_blocks;
+            self.m_free_bytes += block->m_size;
+            ++self.m_free_count[c];
+            self.m_free_size[c] += block->m_size;
+
+            if (block->m_size > self.m_largest_free) {
+                self.m_largest_free = block->m_size;
+            }
+        }
+    }
+
+    return self;
+}
+
+/*!
+    \brief      Prints one row of before, after and the signed difference.
+ */
+static void heapdiff_row(const char *label, uint64_t before, uint64_t after) {
+    printf("%-28s %16llu %16llu %+16lld\n", label,
+           (unsigned long long)(before), (unsigned long long)(after), (long long)(after - before));
+}
+
+/*!
+    \brief      Prints the rows of a size histogram that are non-zero
+                in either profile.
+ */
+static void heapdiff_histogram(const char *title,
+                               const uint64_t *count_before, const uint64_t *size_before,
+                               const uint64_t *count_after, const uint64_t *size_after) {
+    printf("\n%s\n", title);
+    printf("%-12s %12s %12s %12s %16s %16s %16s\n",
+           "size <=", "blocks", "blocks", "delta", "bytes", "bytes", "delta");
+
+    for (size_t c = 0; c < CGCS_PROFILE_CLASS_COUNT; ++c) {
+        if (count_before[c] == 0 && count_after[c] == 0) {
+            continue;
+        }
+
+        printf("%-12llu %12llu %12llu %+12lld %16llu %16llu %+16lld\n",
+               (unsigned long long)((uint64_t)(8) << c),
+               (unsigned long long)(count_before[c]), (unsigned long long)(count_after[c]),
+               (long long)(count_after[c] - count_before[c]),
+               (unsigned long long)(size_before[c]), (unsigned long long)(size_after[c]),
+               (long long)(size_after[c] - size_before[c]));
+    }
+}
+
+/*!
+    \brief      Returns the fragmentation of a summary, in percent:
+                how much of the free space lies outside of the largest free block.
+ */
+static double heapdiff_fragmentation(const heapdiff_summary_t *self) {
+    return self->m_free_bytes ?
+               100.0 * (1.0 - (double)(self->m_largest_free) / (double)(self->m_free_bytes)) : 0.0;
+}
+
+/*!
+    \brief      Program execution begins and ends here.
+
+    \param[in]  argc    Command line argument count
+    \param[in]  argv    Command line arguments
+
+    \return     0 on success, non-zero on failure
+ */
+int main(int argc, const char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <before profile> <after profile>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    cgcs_profile_t before;
+    cgcs_profile_t after;
+
+    if (!cgcs_profile_read(argv[1], &before)) {
+        return EXIT_FAILURE;
+    }
+
+    if (!cgcs_profile_read(argv[2], &after)) {
+        cgcs_profile_release(&before);
+        return EXIT_FAILURE;
+    }
+
+    heapdiff_summary_t a = heapdiff_summarize(&before);
+    heapdiff_summary_t b = heapdiff_summarize(&after);
+
+    printf("cgcs_heapdiff: %s -> %s (%.3f s apart)\n", argv[1], argv[2], after.m_time - before.m_time);
+
+    if (before.m_truncated || after.m_truncated) {
+        printf("warning: a profile is truncated; its block totals are incomplete\n");
+    }
+
+    printf("\n%-28s %16s %16s %16s\n", "", "before", "after", "delta");
+    heapdiff_row("Committed bytes", before.m_committed, after.m_committed);
+    heapdiff_row("Bytes in use", before.m_bytes_allocated - before.m_bytes_freed,
+                 after.m_bytes_allocated - after.m_bytes_freed);
+    heapdiff_row("Allocations", before.m_mallocs, after.m_mallocs);
+    heapdiff_row("Frees", before.m_frees, after.m_frees);
+    heapdiff_row("Used blocks", a.m_used_blocks, b.m_used_blocks);
+    heapdiff_row("Used bytes", a.m_used_bytes, b.m_used_bytes);
+    heapdiff_row("Free blocks", a.m_free_blocks, b.m_free_blocks);
+    heapdiff_row("Free bytes", a.m_free_bytes, b.m_free_bytes);
+    heapdiff_row("Largest free block", a.m_largest_free, b.m_largest_free);
+    heapdiff_row("Header bytes", (a.m_used_blocks + a.m_free_blocks) * before.m_header,
+                 (b.m_used_blocks + b.m_free_blocks) * after.m_header);
+    heapdiff_row("Live large allocations", before.m_large_count, after.m_large_count);
+    heapdiff_row("Live large mappings", before.m_large_bytes, after.m_large_bytes);
+    heapdiff_row("Cached large mappings", before.m_large_cached, after.m_large_cached);
+    printf("%-28s %15.1f%% %15.1f%% %+15.1f%%\n", "Fragmentation",
+           heapdiff_fragmentation(&a), heapdiff_fragmentation(&b),
+           heapdiff_fragmentation(&b) - heapdiff_fragmentation(&a));
+
+    printf("\nAllocations by request size\n");
+    printf("%-12s %16s %16s %16s\n", "size <=", "before", "after", "delta");
+
+    for (size_t c = 0; c < CGCS_PROFILE_CLASS_COUNT; ++c) {
+        if (before.m_class_mallocs[c] == 0 && after.m_class_mallocs[c] == 0) {
+            continue;
+        }
+
+        printf("%-12llu %16llu %16llu %+16lld\n", (unsigned long long)((uint64_t)(8) << c),
+               (unsigned long long)(before.m_class_mallocs[c]), (unsigned long long)(after.m_class_mallocs[c]),
+               (long long)(after.m_class_mallocs[c] - before.m_class_mallocs[c]));
+    }
+
+    heapdiff_histogram("Used blocks by size", a.m_used_count, a.m_used_size, b.m_used_count, b.m_used_size);
+    heapdiff_histogram("Free blocks by size", a.m_free_count, a.m_free_size, b.m_free_count, b.m_free_size);
+
+    cgcs_profile_release(&before);
+    cgcs_profile_release(&after);
+
+    return EXIT_SUCCESS;
+}
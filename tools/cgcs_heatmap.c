@@ -0,0 +1,230 @@
+/*!
+    \file       cgcs_heatmap.c
+    \brief      Renders a cgcs heap profile as a fragmentation heat map
+
+    \details
+    Usage: cgcs_heatmap <profile> <image.ppm | image.svg> [width] [granule]
+
+    Every cell of the image stands for `granule` bytes of `block`, laid out
+    row by row in address order, `width` cells per row (default 256).
+    A cell is coloured by what its bytes hold -- red for used blocks,
+    green for free blocks, grey for headers -- blended in proportion
+    when it holds more than one. Without `granule`, the smallest power of two
+    of at least the header size that keeps the image within 1024 rows is used.
+
+    A large request that fails on a half-empty heap shows up as green
+    spread thinly between red, with no long green run.
+
+    \author     Gemuele Aludino
+    \date       18 Oct 2026
+ */
+
+#include "cgcs_profile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HEATMAP_DEFAULT_WIDTH   256
+#define HEATMAP_MAX_ROWS        1024    //!< rows the automatic granule aims for
+#define HEATMAP_SVG_CELL        4       //!< side of a cell in an SVG, in pixels
+
+/*!
+    \enum       heatmap_state
+    \brief      What a byte of `block` holds
+ */
+enum heatmap_state {
+    HEATMAP_USED,
+    HEATMAP_FREE,
+    HEATMAP_HEADER,
+    HEATMAP_STATE_COUNT
+};
+
+static const unsigned char heatmap_colors[HEATMAP_STATE_COUNT][3] = {
+    { 214, 39, 40 },    // used
+    { 44, 160, 44 },    // free
+    { 127, 127, 127 }   // header
+};
+
+static const unsigned char heatmap_uncommitted[3] = { 0, 0, 0 };
+
+/*!
+    \brief      Adds the bytes [`begin`, `end`) of `state` to every cell they cover.
+ */
+static void heatmap_add(uint32_t (*cells)[HEATMAP_STATE_COUNT], size_t cell_count, uint64_t granule,
+                        uint64_t begin, uint64_t end, enum heatmap_state state) {
+    while (begin < end) {
+        uint64_t cell = begin / granule;
+        uint64_t cell_end = (cell + 1) * granule;
+        uint64_t stop = end < cell_end ? end : cell_end;
+
+        if (cell >= cell_count) {
+            return;
+        }
+
+        cells[cell][state] += (uint32_t)(stop - begin);
+        begin = stop;
+    }
+}
+
+/*!
+    \brief      Blends the colour of one cell into `rgb`.
+ */
+static void heatmap_color(const uint32_t counts[HEATMAP_STATE_COUNT], unsigned char rgb[3]) {
+    uint64_t total = 0;
+
+    for (size_t s = 0; s < HEATMAP_STATE_COUNT; ++s) {
+        total += counts[s];
+    }
+
+    if (total == 0) {
+        memcpy(rgb, heatmap_uncommitted, 3);
+        return;
+    }
+
+    for (size_t c = 0; c < 3; ++c) {
+        uint64_t sum = 0;
+
+        for (size_t s = 0; s < HEATMAP_STATE_COUNT; ++s) {
+            sum += (uint64_t)(counts[s]) * heatmap_colors[s][c];
+        }
+
+        rgb[c] = (unsigned char)(sum / total);
+    }
+}
+
+/*!
+    \brief      Writes the cells as a binary PPM (P6) image.
+ */
+static bool heatmap_write_ppm(FILE *f, uint32_t (*cells)[HEATMAP_STATE_COUNT], size_t width, size_t rows) {
+    fprintf(f, "P6\n%lu %lu\n255\n", (unsigned long)(width), (unsigned long)(rows));
+
+    for (size_t i = 0; i < width * rows; ++i) {
+        unsigned char rgb[3];
+        heatmap_color(cells[i], rgb);
+        fwrite(rgb, 1, sizeof rgb, f);
+    }
+
+    return !ferror(f);
+}
+
+/*!
+    \brief      Writes the cells as an SVG image; runs of equally coloured
+                cells within a row become a single rectangle.
+ */
+static bool heatmap_write_svg(FILE *f, uint32_t (*cells)[HEATMAP_STATE_COUNT], size_t width, size_t rows,
+                              uint64_t granule) {
+    fprintf(f, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%lu\" height=\"%lu\" shape-rendering=\"crispEdges\">\n",
+            (unsigned long)(width * HEATMAP_SVG_CELL), (unsigned long)(rows * HEATMAP_SVG_CELL));
+    fprintf(f, "<title>cgcs heap, %llu bytes per cell</title>\n", (unsigned long long)(granule));
+
+    for (size_t y = 0; y < rows; ++y) {
+        size_t x = 0;
+
+        while (x < width) {
+            unsigned char rgb[3];
+            unsigned char next[3];
+            size_t run = 1;
+
+            heatmap_color(cells[y * width + x], rgb);
+
+            while (x + run < width) {
+                heatmap_color(cells[y * width + x + run], next);
+
+                if (memcmp(rgb, next, sizeof rgb) != 0) {
+                    break;
+                }
+
+                ++run;
+            }
+
+            fprintf(f, "<rect x=\"%lu\" y=\"%lu\" width=\"%lu\" height=\"%d\" fill=\"#%02x%02x%02x\"/>\n",
+                    (unsigned long)(x * HEATMAP_SVG_CELL), (unsigned long)(y * HEATMAP_SVG_CELL),
+                    (unsigned long)(run * HEATMAP_SVG_CELL), HEATMAP_SVG_CELL, rgb[0], rgb[1], rgb[2]);
+
+            x += run;
+        }
+    }
+
+    fprintf(f, "</svg>\n");
+    return !ferror(f);
+}
+
+/*!
+    \brief      Program execution begins and ends here.
+
+    \param[in]  argc    Command line argument count
+    \param[in]  argv    Command line arguments
+
+    \return     0 on success, non-zero on failure
+ */
+int main(int argc, const char *argv[]) {
+    if (argc < 3 || argc > 5) {
+        fprintf(stderr, "usage: %s <profile> <image.ppm | image.svg> [width] [granule]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    size_t length = strlen(argv[2]);
+    bool svg = length >= 4 && strcmp(argv[2] + length - 4, ".svg") == 0;
+    size_t width = argc > 3 ? strtoul(argv[3], NULL, 10) : HEATMAP_DEFAULT_WIDTH;
+    uint64_t granule = argc > 4 ? strtoull(argv[4], NULL, 10) : 0;
+
+    if (width == 0) {
+        fprintf(stderr, "%s: width must be at least 1\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    cgcs_profile_t profile;
+
+    if (!cgcs_profile_read(argv[1], &profile)) {
+        return EXIT_FAILURE;
+    }
+
+    if (granule == 0) {
+        granule = profile.m_header ? profile.m_header : 1;
+
+        while ((profile.m_committed + granule * width - 1) / (granule * width) > HEATMAP_MAX_ROWS) {
+            granule *= 2;
+        }
+    }
+
+    size_t rows = (size_t)((profile.m_committed + granule * width - 1) / (granule * width));
+    rows = rows > 0 ? rows : 1;
+
+    uint32_t (*cells)[HEATMAP_STATE_COUNT] = calloc(width * rows, sizeof *cells);
+
+    if (!cells) {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        cgcs_profile_release(&profile);
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < profile.m_block_count; ++i) {
+        const cgcs_profile_block_t *block = &profile.m_blocks[i];
+        uint64_t data = block->m_offset + profile.m_header;
+
+        heatmap_add(cells, width * rows, granule, block->m_offset, data, HEATMAP_HEADER);
+        heatmap_add(cells, width * rows, granule, data, data + block->m_size,
+                    block->m_used ? HEATMAP_USED : HEATMAP_FREE);
+    }
+
+    FILE *f = fopen(argv[2], "wb");
+    bool written = f && (svg ? heatmap_write_svg(f, cells, width, rows, granule) :
+                               heatmap_write_ppm(f, cells, width, rows));
+
+    if (f && fclose(f) != 0) {
+        written = false;
+    }
+
+    if (written) {
+        printf("%s: %lu x %lu cells of %llu bytes\n",
+               argv[2], (unsigned long)(width), (unsigned long)(rows), (unsigned long long)(granule));
+    } else {
+        fprintf(stderr, "%s: unable to write %s\n", argv[0], argv[2]);
+    }
+
+    free(cells);
+    cgcs_profile_release(&profile);
+
+    return written ? EXIT_SUCCESS : EXIT_FAILURE;
+}
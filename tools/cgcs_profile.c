@@ -0,0 +1,124 @@
+/*!
+    \file       cgcs_profile.c
+    \brief      Reader for the heap profiles written by `cgcs_profile_fputs`
+
+    \author     Gemuele Aludino
+    \date       18 Oct 2026
+ */
+
+#include "cgcs_profile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROFILE_MIN_BLOCKS  1024
+
+/*!
+    \brief      Appends one block to `self`, growing `m_blocks` as needed.
+
+    \return     `true` on success, `false` if memory could not be allocated.
+ */
+static bool profile_append(cgcs_profile_t *self, size_t *capacity, const cgcs_profile_block_t *block) {
+    if (self->m_block_count == *capacity) {
+        size_t grown = *capacity ? *capacity * 2 : PROFILE_MIN_BLOCKS;
+        cgcs_profile_block_t *blocks = realloc(self->m_blocks, grown * sizeof *blocks);
+
+        if (!blocks) {
+            return false;
+        }
+
+        self->m_blocks = blocks;
+        *capacity = grown;
+    }
+
+    self->m_blocks[self->m_block_count++] = *block;
+    return true;
+}
+
+bool cgcs_profile_read(const char *path, cgcs_profile_t *self) {
+    memset(self, 0, sizeof *self);
+
+    FILE *f = fopen(path, "r");
+    char line[256];
+    int version = 0;
+
+    if (!f || !fgets(line, sizeof line, f)
+    || sscanf(line, "cgcs_heap_profile %d", &version) != 1 || version != CGCS_PROFILE_VERSION) {
+        fprintf(stderr, "%s is not a version %d cgcs heap profile\n", path, CGCS_PROFILE_VERSION);
+
+        if (f) {
+            fclose(f);
+        }
+
+        return false;
+    }
+
+    size_t capacity = 0;
+    bool ended = false;
+
+    while (!ended && fgets(line, sizeof line, f)) {
+        cgcs_profile_block_t block = { 0, 0, false };
+        unsigned long long a = 0;
+        unsigned long long b = 0;
+        char state[8] = "";
+
+        if (sscanf(line, "block %llu %llu %7s", &a, &b, state) == 3) {
+            block.m_offset = a;
+            block.m_size = b;
+            block.m_used = strcmp(state, "used") == 0;
+
+            if (!profile_append(self, &capacity, &block)) {
+                fprintf(stderr, "%s: out of memory\n", path);
+                cgcs_profile_release(self);
+                fclose(f);
+                return false;
+            }
+        } else if (sscanf(line, "class %llu %llu", &a, &b) == 2) {
+            if (a < CGCS_PROFILE_CLASS_COUNT) {
+                self->m_class_mallocs[a] = b;
+            }
+        } else if (sscanf(line, "pid %ld", &self->m_pid) == 1
+               || sscanf(line, "time %lf", &self->m_time) == 1) {
+            continue;
+        } else if (sscanf(line, "committed %llu", &a) == 1) {
+            self->m_committed = a;
+        } else if (sscanf(line, "header %llu", &a) == 1) {
+            self->m_header = a;
+        } else if (sscanf(line, "mallocs %llu", &a) == 1) {
+            self->m_mallocs = a;
+        } else if (sscanf(line, "frees %llu", &a) == 1) {
+            self->m_frees = a;
+        } else if (sscanf(line, "bytes_allocated %llu", &a) == 1) {
+            self->m_bytes_allocated = a;
+        } else if (sscanf(line, "bytes_freed %llu", &a) == 1) {
+            self->m_bytes_freed = a;
+        } else if (sscanf(line, "large_count %llu", &a) == 1) {
+            self->m_large_count = a;
+        } else if (sscanf(line, "large_bytes %llu", &a) == 1) {
+            self->m_large_bytes = a;
+        } else if (sscanf(line, "large_cached %llu", &a) == 1) {
+            self->m_large_cached = a;
+        } else if (sscanf(line, "blocks %llu %7s", &a, state) >= 1) {
+            self->m_truncated = strcmp(state, "truncated") == 0;
+        } else if (strncmp(line, "end", 3) == 0) {
+            ended = true;
+        }
+    }
+
+    fclose(f);
+
+    if (!ended) {
+        fprintf(stderr, "%s: incomplete heap profile\n", path);
+        cgcs_profile_release(self);
+        return false;
+    }
+
+    return true;
+}
+
+void cgcs_profile_release(cgcs_profile_t *self) {
+    free(self->m_blocks);
+    self->m_blocks = NULL;
+    self->m_block_count = 0;
+}
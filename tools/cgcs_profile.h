@@ -0,0 +1,86 @@
+/*!
+    \file       cgcs_profile.h
+    \brief      Reader for the heap profiles written by `cgcs_profile_fputs`,
+                shared by the heap profile tools
+
+    \author     Gemuele Aludino
+    \date       18 Oct 2026
+ */
+
+#ifndef CGCS_PROFILE_H
+#define CGCS_PROFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CGCS_PROFILE_VERSION        1   //!< mirrors `CGCS_PROFILE_VERSION` in cgcs_malloc.c
+#define CGCS_PROFILE_CLASS_COUNT    28  //!< mirrors `CGCS_STATS_CLASS_COUNT` in cgcs_malloc.h
+
+/*!
+    \typedef    cgcs_profile_block_t
+    \brief      One block of a profile, in address order
+ */
+typedef struct cgcs_profile_block {
+    uint64_t m_offset;  //! offset of the block's header from the start of `block`
+    uint64_t m_size;    //! usable size
+    bool m_used;
+} cgcs_profile_block_t;
+
+/*!
+    \typedef    cgcs_profile_t
+    \brief      A heap profile, as read by `cgcs_profile_read`
+ */
+typedef struct cgcs_profile {
+    long m_pid;
+    double m_time;          //! seconds since the epoch
+    uint64_t m_committed;   //! committed bytes of `block`
+    uint64_t m_header;      //! bytes of metadata in front of every block
+
+    uint64_t m_mallocs;
+    uint64_t m_frees;
+    uint64_t m_bytes_allocated;
+    uint64_t m_bytes_freed;
+    uint64_t m_class_mallocs[CGCS_PROFILE_CLASS_COUNT];
+    uint64_t m_large_count;     //! live large allocations, each in a mapping of its own
+    uint64_t m_large_bytes;     //! length of their mappings
+    uint64_t m_large_cached;    //! length of freed large mappings kept for reuse
+
+    cgcs_profile_block_t *m_blocks;
+    size_t m_block_count;
+    bool m_truncated;       //! the heap grew while the profile was captured
+} cgcs_profile_t;
+
+/*!
+    \brief      Reads the heap profile at `path` into `self`.
+
+    \details    Unknown records are skipped, so that newer profiles
+                of the same version stay readable.
+
+    \param[in]  path    Profile written by `cgcs_profile_fputs`
+    \param[out] self    Receives the profile; release it with `cgcs_profile_release`
+
+    \return     `true` on success, `false` (after printing why) otherwise.
+ */
+bool cgcs_profile_read(const char *path, cgcs_profile_t *self);
+
+/*!
+    \brief      Releases the blocks read by `cgcs_profile_read`.
+ */
+void cgcs_profile_release(cgcs_profile_t *self);
+
+/*!
+    \brief      Returns the power-of-two size class of `size` bytes:
+                0 for up to 8 bytes, `i` for up to `8 << i` bytes.
+ */
+static inline size_t cgcs_profile_class_index(uint64_t size) {
+    size_t i = 0;
+
+    while (i + 1 < CGCS_PROFILE_CLASS_COUNT && ((uint64_t)(8) << i) < size) {
+        ++i;
+    }
+
+    return i;
+}
+
+#endif /* CGCS_PROFILE_H */
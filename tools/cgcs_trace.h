@@ -0,0 +1,62 @@
+/*!
+    \file       cgcs_trace.h
+    \brief      Binary allocation trace format, shared by the capture shim
+                and the replay tool
+
+    \details
+    A trace is a `cgcs_trace_header_t`, followed by `cgcs_trace_record_t`s
+    in the order the operations took effect. All fields are in host byte order.
+
+    \author     Gemuele Aludino
+    \date       18 Oct 2026
+ */
+
+#ifndef CGCS_TRACE_H
+#define CGCS_TRACE_H
+
+#include <stdint.h>
+
+#define CGCS_TRACE_MAGIC    "CGCSTRC"   //!< first 8 bytes of a trace, including the terminator
+#define CGCS_TRACE_VERSION  1
+
+/*!
+    \enum       cgcs_trace_op
+    \brief      Allocation function that produced a record
+ */
+enum cgcs_trace_op {
+    CGCS_TRACE_MALLOC,      //!< `malloc(m_size)` returned `m_id`
+    CGCS_TRACE_CALLOC,      //!< `calloc` of `m_size` bytes in total returned `m_id`
+    CGCS_TRACE_REALLOC,     //!< `realloc(m_old_id, m_size)` returned `m_id`
+    CGCS_TRACE_MEMALIGN,    //!< an aligned allocation of `m_size` bytes returned `m_id`
+    CGCS_TRACE_FREE         //!< `free(m_id)`
+};
+
+/*!
+    \typedef    cgcs_trace_header_t
+    \brief      Leading header of a trace file
+ */
+typedef struct cgcs_trace_header {
+    char m_magic[8];        //! `CGCS_TRACE_MAGIC`
+    uint32_t m_version;     //! `CGCS_TRACE_VERSION`
+    uint32_t m_record_size; //! `sizeof(cgcs_trace_record_t)`
+} cgcs_trace_header_t;
+
+/*!
+    \typedef    cgcs_trace_record_t
+    \brief      One allocation operation
+
+    \details
+    Pointer IDs are the addresses the traced process saw; an ID is only
+    meaningful between the record that returned it and the record that
+    freed (or reallocated) it.
+ */
+typedef struct cgcs_trace_record {
+    uint64_t m_timestamp_ns;    //! time since the capture started
+    uint32_t m_thread;          //! capture-assigned thread number, from 0
+    uint32_t m_op;              //! `enum cgcs_trace_op`
+    uint64_t m_size;            //! requested size, in bytes; 0 for `CGCS_TRACE_FREE`
+    uint64_t m_id;              //! pointer ID returned (or freed); 0 for `NULL`
+    uint64_t m_old_id;          //! pointer ID passed to `realloc`; 0 otherwise
+} cgcs_trace_record_t;
+
+#endif /* CGCS_TRACE_H */
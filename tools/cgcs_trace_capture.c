@@ -0,0 +1,515 @@
+/*!
+    \file       cgcs_trace_capture.c
+    \brief      LD_PRELOAD shim that records the allocation calls
+                of an unmodified process as a cgcs trace
+
+    \details
+    Usage:
+
+    ```
+    % CGCS_TRACE_FILE=./service.trace LD_PRELOAD=./libcgcs_trace_capture.so ./service
+    % cgcs_trace_replay ./service.trace
+    ```
+
+    `malloc`, `calloc`, `realloc`, `reallocarray`, `free`, `posix_memalign`,
+    `aligned_alloc`, `memalign`, `valloc` and `pvalloc` are interposed and
+    forwarded to the next definition (normally libc).
+
+    `%p` in `CGCS_TRACE_FILE` is replaced with the process ID; without
+    `CGCS_TRACE_FILE`, the trace is written to `cgcs_trace.%p.bin`.
+    Every traced process writes a trace of its own: a child, whether
+    `fork`ed or started by `exec` (the first traced process sets
+    `CGCS_TRACE_ROOT` for its descendants), appends `.<pid>` to a path
+    without `%p`, so that it never truncates or writes into its parent's trace.
+
+    Records are appended under one lock; `free` and `realloc` hold it across
+    the forwarded call, so an address is never recorded as reused
+    before the record that released it.
+
+    \author     Gemuele Aludino
+    \date       18 Oct 2026
+ */
+
+// `clock_gettime` and `CLOCK_MONOTONIC` are hidden by strict ISO C (`-std=c11`).
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include "cgcs_trace.h"
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define CAPTURE_BUFFER_RECORDS  4096    //!< records buffered between writes
+#define CAPTURE_BOOTSTRAP_SIZE  4096    //!< bytes served while `dlsym` resolves the real functions
+#define CAPTURE_PATH_MAX        4096    //!< longest trace path, once `%p` is expanded
+#define CAPTURE_ROOT_ENV        "CGCS_TRACE_ROOT"   //!< set by the first traced process, for its descendants
+
+static void *(*real_malloc)(size_t);
+static void *(*real_calloc)(size_t, size_t);
+static void *(*real_realloc)(void *, size_t);
+static void (*real_free)(void *);
+static int (*real_posix_memalign)(void **, size_t, size_t);
+static void *(*real_aligned_alloc)(size_t, size_t);
+static void *(*real_memalign)(size_t, size_t);
+static void *(*real_valloc)(size_t);
+static void *(*real_pvalloc)(size_t);
+
+static pthread_mutex_t capture_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static cgcs_trace_record_t capture_buffer[CAPTURE_BUFFER_RECORDS];
+static size_t capture_count;
+static int capture_fd = -1;
+static struct timespec capture_start;
+static char capture_pattern[CAPTURE_PATH_MAX];
+
+static atomic_uint capture_next_thread;
+static _Thread_local uint32_t capture_thread = UINT32_MAX;
+
+/*
+    `dlsym` may allocate while the real functions are being resolved;
+    those requests are served from `capture_bootstrap` and never recorded.
+ */
+static bool capture_resolving;
+static char capture_bootstrap[CAPTURE_BOOTSTRAP_SIZE] __attribute__((aligned(16)));
+static size_t capture_bootstrap_used;
+
+/*!
+    \brief      Looks up the next definition of every interposed function.
+ */
+static void capture_resolve() {
+    capture_resolving = true;
+
+    *(void **)(&real_malloc) = dlsym(RTLD_NEXT, "malloc");
+    *(void **)(&real_calloc) = dlsym(RTLD_NEXT, "calloc");
+    *(void **)(&real_realloc) = dlsym(RTLD_NEXT, "realloc");
+    *(void **)(&real_free) = dlsym(RTLD_NEXT, "free");
+    *(void **)(&real_posix_memalign) = dlsym(RTLD_NEXT, "posix_memalign");
+    *(void **)(&real_aligned_alloc) = dlsym(RTLD_NEXT, "aligned_alloc");
+    *(void **)(&real_memalign) = dlsym(RTLD_NEXT, "memalign");
+    *(void **)(&real_valloc) = dlsym(RTLD_NEXT, "valloc");
+    *(void **)(&real_pvalloc) = dlsym(RTLD_NEXT, "pvalloc");
+
+    capture_resolving = false;
+}
+
+/*!
+    \brief      Serves an allocation from `capture_bootstrap`.
+
+    \param[in]  size    Requested size, in bytes
+
+    \return     zeroed memory, or `NULL` if the bootstrap buffer is exhausted
+ */
+static void *capture_bootstrap_alloc(size_t size) {
+    size_t offset = (capture_bootstrap_used + 15) & ~(size_t)(15);
+
+    if (offset + size > CAPTURE_BOOTSTRAP_SIZE) {
+        return NULL;
+    }
+
+    capture_bootstrap_used = offset + size;
+    return capture_bootstrap + offset;
+}
+
+/*!
+    \brief      Determines if `ptr` was served by `capture_bootstrap_alloc`.
+ */
+static inline bool capture_is_bootstrap(void *ptr) {
+    return (char *)(ptr) >= capture_bootstrap && (char *)(ptr) < capture_bootstrap + CAPTURE_BOOTSTRAP_SIZE;
+}
+
+/*!
+    \brief      Writes every buffered record to the trace file.
+
+    Precondition: `capture_lock` is held
+ */
+static void capture_flush() {
+    const char *bytes = (const char *)(capture_buffer);
+    size_t remaining = capture_count * sizeof *capture_buffer;
+
+    while (remaining > 0 && capture_fd >= 0) {
+        ssize_t written = write(capture_fd, bytes, remaining);
+
+        if (written <= 0) {
+            close(capture_fd);
+            capture_fd = -1;
+            break;
+        }
+
+        bytes += written;
+        remaining -= (size_t)(written);
+    }
+
+    capture_count = 0;
+}
+
+/*!
+    \brief      Appends one record to the trace.
+
+    \param[in]  op      `enum cgcs_trace_op`
+    \param[in]  size    Requested size, in bytes
+    \param[in]  ptr     Address returned (or freed)
+    \param[in]  old     Address passed to `realloc`, `NULL` otherwise
+
+    Precondition: `capture_lock` is held
+ */
+static void capture_append(uint32_t op, size_t size, void *ptr, void *old) {
+    if (capture_fd < 0) {
+        return;
+    }
+
+    if (capture_thread == UINT32_MAX) {
+        capture_thread = atomic_fetch_add(&capture_next_thread, 1);
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    cgcs_trace_record_t *record = &capture_buffer[capture_count++];
+
+    record->m_timestamp_ns = (uint64_t)(now.tv_sec - capture_start.tv_sec) * 1000000000ULL
+                           + (uint64_t)(now.tv_nsec) - (uint64_t)(capture_start.tv_nsec);
+    record->m_thread = capture_thread;
+    record->m_op = op;
+    record->m_size = size;
+    record->m_id = (uint64_t)((uintptr_t)(ptr));
+    record->m_old_id = (uint64_t)((uintptr_t)(old));
+
+    if (capture_count == CAPTURE_BUFFER_RECORDS) {
+        capture_flush();
+    }
+}
+
+/*!
+    \brief      Records an allocation that has already returned `ptr`.
+ */
+static void capture_allocation(uint32_t op, size_t size, void *ptr) {
+    pthread_mutex_lock(&capture_lock);
+    capture_append(op, size, ptr, NULL);
+    pthread_mutex_unlock(&capture_lock);
+}
+
+/*!
+    \brief      Writes the trace path of the calling process to `path`.
+
+    \details    `%p` in `capture_pattern` is replaced with the process ID,
+                and `%%` with `%`. A process whose parent is traced as well
+                appends `.<pid>` to a pattern without `%p`.
+
+    \param[out] path        Receives the path; `CAPTURE_PATH_MAX` bytes
+    \param[in]  inherited   `true` if the capture was inherited from a parent process
+
+    \return     `true` on success, `false` if the path does not fit.
+ */
+static bool capture_path(char *path, bool inherited) {
+    long pid = (long)(getpid());
+    bool expanded = false;
+    size_t length = 0;
+
+    for (const char *c = capture_pattern; *c; ++c) {
+        int written = 1;
+
+        if (c[0] == '%' && c[1] == 'p') {
+            written = snprintf(path + length, CAPTURE_PATH_MAX - length, "%ld", pid);
+            expanded = true;
+            ++c;
+        } else if (length + 1 < CAPTURE_PATH_MAX) {
+            c += c[0] == '%' && c[1] == '%';
+            path[length] = *c;
+        }
+
+        if (written < 0 || length + (size_t)(written) >= CAPTURE_PATH_MAX) {
+            return false;
+        }
+
+        length += (size_t)(written);
+    }
+
+    path[length] = '\0';
+
+    if (inherited && !expanded) {
+        int written = snprintf(path + length, CAPTURE_PATH_MAX - length, ".%ld", pid);
+        return written >= 0 && length + (size_t)(written) < CAPTURE_PATH_MAX;
+    }
+
+    return true;
+}
+
+/*!
+    \brief      Creates the trace file of the calling process, writes its header,
+                and restarts the capture clock.
+
+    \param[in]  inherited   `true` if the capture was inherited from a parent process
+
+    \return     the file's descriptor, or -1 on failure
+ */
+static int capture_begin(bool inherited) {
+    char path[CAPTURE_PATH_MAX];
+
+    if (!capture_path(path, inherited)) {
+        fprintf(stderr, "[ERROR: cgcs_trace_capture] The trace path %s is too long.\n", capture_pattern);
+        return -1;
+    }
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd < 0) {
+        fprintf(stderr, "[ERROR: cgcs_trace_capture] Unable to open trace file %s\n", path);
+        return -1;
+    }
+
+    cgcs_trace_header_t header = { CGCS_TRACE_MAGIC, CGCS_TRACE_VERSION, sizeof(cgcs_trace_record_t) };
+
+    if (write(fd, &header, sizeof header) != sizeof header) {
+        fprintf(stderr, "[ERROR: cgcs_trace_capture] Unable to write trace header to %s\n", path);
+        close(fd);
+        return -1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &capture_start);
+    return fd;
+}
+
+/*!
+    \brief      Holds `capture_lock` across `fork`, so that the child
+                inherits the buffer and the thread numbering in a consistent state.
+ */
+static void capture_fork_prepare() {
+    pthread_mutex_lock(&capture_lock);
+}
+
+/*!
+    \brief      Releases `capture_lock` in the parent once `fork` returns.
+ */
+static void capture_fork_parent() {
+    pthread_mutex_unlock(&capture_lock);
+}
+
+/*!
+    \brief      Starts a trace of the child's own after `fork`.
+
+    \details    The records the child inherited in `capture_buffer` are
+                the parent's to write, and are dropped; so is the parent's
+                trace file. The child numbers its threads from 0 again.
+ */
+static void capture_fork_child() {
+    capture_count = 0;
+
+    if (capture_fd >= 0) {
+        close(capture_fd);
+        capture_fd = -1;
+    }
+
+    atomic_store(&capture_next_thread, 0);
+    capture_thread = UINT32_MAX;
+
+    pthread_mutex_unlock(&capture_lock);
+
+    // Allocations made while the file is created are not recorded: `capture_fd` is -1.
+    int fd = capture_begin(true);
+
+    pthread_mutex_lock(&capture_lock);
+    capture_fd = fd;
+    pthread_mutex_unlock(&capture_lock);
+}
+
+/*!
+    \brief      Resolves the real allocation functions and opens the trace file
+                when the shim is loaded.
+ */
+__attribute__((constructor)) static void capture_open() {
+    if (!real_malloc) {
+        capture_resolve();
+    }
+
+    const char *pattern = getenv("CGCS_TRACE_FILE");
+    bool inherited = getenv(CAPTURE_ROOT_ENV) != NULL;
+
+    if (!pattern || !*pattern) {
+        pattern = "cgcs_trace.%p.bin";
+    }
+
+    if (strlen(pattern) >= sizeof capture_pattern) {
+        fprintf(stderr, "[ERROR: cgcs_trace_capture] The trace path %s is too long.\n", pattern);
+        return;
+    }
+
+    strcpy(capture_pattern, pattern);
+
+    if (!inherited) {
+        char root[32];
+        snprintf(root, sizeof root, "%ld", (long)(getpid()));
+        setenv(CAPTURE_ROOT_ENV, root, 0);
+    }
+
+    int fd = capture_begin(inherited);
+
+    if (fd < 0) {
+        return;
+    }
+
+    pthread_atfork(capture_fork_prepare, capture_fork_parent, capture_fork_child);
+
+    pthread_mutex_lock(&capture_lock);
+    capture_fd = fd;
+    pthread_mutex_unlock(&capture_lock);
+}
+
+/*!
+    \brief      Flushes and closes the trace file when the process exits;
+                later calls are forwarded but no longer recorded.
+ */
+__attribute__((destructor)) static void capture_close() {
+    pthread_mutex_lock(&capture_lock);
+
+    capture_flush();
+
+    if (capture_fd >= 0) {
+        close(capture_fd);
+        capture_fd = -1;
+    }
+
+    pthread_mutex_unlock(&capture_lock);
+}
+
+void *malloc(size_t size) {
+    if (!real_malloc) {
+        if (capture_resolving) {
+            return capture_bootstrap_alloc(size);
+        }
+
+        capture_resolve();
+    }
+
+    void *ptr = real_malloc(size);
+    capture_allocation(CGCS_TRACE_MALLOC, size, ptr);
+    return ptr;
+}
+
+void *calloc(size_t count, size_t size) {
+    if (!real_calloc) {
+        if (capture_resolving) {
+            return capture_bootstrap_alloc(count * size);
+        }
+
+        capture_resolve();
+    }
+
+    void *ptr = real_calloc(count, size);
+    capture_allocation(CGCS_TRACE_CALLOC, count * size, ptr);
+    return ptr;
+}
+
+void *realloc(void *old, size_t size) {
+    if (!real_realloc) {
+        capture_resolve();
+    }
+
+    if (capture_is_bootstrap(old)) {
+        void *ptr = malloc(size);
+
+        if (ptr) {
+            size_t available = (size_t)(capture_bootstrap + CAPTURE_BOOTSTRAP_SIZE - (char *)(old));
+            memcpy(ptr, old, size < available ? size : available);
+        }
+
+        return ptr;
+    }
+
+    pthread_mutex_lock(&capture_lock);
+    void *ptr = real_realloc(old, size);
+    capture_append(CGCS_TRACE_REALLOC, size, ptr, old);
+    pthread_mutex_unlock(&capture_lock);
+
+    return ptr;
+}
+
+void free(void *ptr) {
+    if (!ptr || capture_is_bootstrap(ptr)) {
+        return;
+    }
+
+    if (!real_free) {
+        capture_resolve();
+    }
+
+    pthread_mutex_lock(&capture_lock);
+    capture_append(CGCS_TRACE_FREE, 0, ptr, NULL);
+    real_free(ptr);
+    pthread_mutex_unlock(&capture_lock);
+}
+
+int posix_memalign(void **out, size_t alignment, size_t size) {
+    if (!real_posix_memalign) {
+        capture_resolve();
+    }
+
+    int result = real_posix_memalign(out, alignment, size);
+
+    if (result == 0) {
+        capture_allocation(CGCS_TRACE_MEMALIGN, size, *out);
+    }
+
+    return result;
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    if (!real_aligned_alloc) {
+        capture_resolve();
+    }
+
+    void *ptr = real_aligned_alloc(alignment, size);
+    capture_allocation(CGCS_TRACE_MEMALIGN, size, ptr);
+    return ptr;
+}
+
+void *reallocarray(void *old, size_t count, size_t size) {
+    // An overflowing request fails without calling `realloc`, and is not recorded.
+    if (size != 0 && count > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    return realloc(old, count * size);
+}
+
+void *memalign(size_t alignment, size_t size) {
+    if (!real_memalign) {
+        capture_resolve();
+    }
+
+    void *ptr = real_memalign(alignment, size);
+    capture_allocation(CGCS_TRACE_MEMALIGN, size, ptr);
+    return ptr;
+}
+
+void *valloc(size_t size) {
+    if (!real_valloc) {
+        capture_resolve();
+    }
+
+    void *ptr = real_valloc(size);
+    capture_allocation(CGCS_TRACE_MEMALIGN, size, ptr);
+    return ptr;
+}
+
+void *pvalloc(size_t size) {
+    if (!real_pvalloc) {
+        capture_resolve();
+    }
+
+    void *ptr = real_pvalloc(size);
+    capture_allocation(CGCS_TRACE_MEMALIGN, size, ptr);
+    return ptr;
+}
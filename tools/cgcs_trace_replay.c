@@ -0,0 +1,300 @@
+/*!
+    \file       cgcs_trace_replay.c
+    \brief      Replays a cgcs allocation trace against cgcs_malloc
+
+    \details
+    Usage: cgcs_trace_replay <trace file>
+
+    Every record of the trace is replayed, in order, on the calling thread.
+    `calloc` and aligned allocations are replayed as `cgcs_malloc`;
+    `realloc` is replayed as `cgcs_malloc`, a copy and `cgcs_free`.
+    Frees of addresses allocated before the capture started are counted
+    as unmatched, and skipped.
+
+    \author     Gemuele Aludino
+    \date       18 Oct 2026
+ */
+
+// `clock_gettime` and `CLOCK_MONOTONIC` are hidden by strict ISO C (`-std=c11`).
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include "cgcs_malloc.h"
+#include "cgcs_trace.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define REPLAY_READ_RECORDS     4096    //!< records read from the trace at a time
+#define REPLAY_TABLE_MIN_SLOTS  1024
+
+/*!
+    \typedef    replay_slot_t
+    \brief      Live replayed allocation, keyed by its pointer ID in the trace
+ */
+typedef struct replay_slot {
+    uint64_t m_id;      //! 0 marks an empty slot
+    void *m_ptr;        //! `NULL` if `cgcs_malloc` failed on replay
+    size_t m_size;
+} replay_slot_t;
+
+/*!
+    \typedef    replay_table_t
+    \brief      Open-addressing (linear probing) map of pointer ID to `replay_slot_t`
+ */
+typedef struct replay_table {
+    replay_slot_t *m_slots;
+    size_t m_capacity;  //! power of two
+    size_t m_count;
+} replay_table_t;
+
+/*!
+    \brief      Returns the home slot of `id` within a table of `capacity` slots.
+ */
+static inline size_t replay_hash(uint64_t id, size_t capacity) {
+    id ^= id >> 33;
+    id *= 0xff51afd7ed558ccdULL;
+    id ^= id >> 33;
+    return (size_t)(id) & (capacity - 1);
+}
+
+/*!
+    \brief      Returns the slot holding `id`, or the empty slot where it belongs.
+ */
+static replay_slot_t *replay_table_find(replay_table_t *self, uint64_t id) {
+    size_t i = replay_hash(id, self->m_capacity);
+
+    while (self->m_slots[i].m_id != 0 && self->m_slots[i].m_id != id) {
+        i = (i + 1) & (self->m_capacity - 1);
+    }
+
+    return &self->m_slots[i];
+}
+
+/*!
+    \brief      Doubles the capacity of `self`, rehashing every slot.
+
+    \return     `true` on success, `false` if memory could not be allocated.
+ */
+static bool replay_table_grow(replay_table_t *self) {
+    replay_table_t grown = { NULL, self->m_capacity ? self->m_capacity * 2 : REPLAY_TABLE_MIN_SLOTS, self->m_count };
+    grown.m_slots = calloc(grown.m_capacity, sizeof *grown.m_slots);
+
+    if (!grown.m_slots) {
+        return false;
+    }
+
+    for (size_t i = 0; i < self->m_capacity; ++i) {
+        if (self->m_slots[i].m_id != 0) {
+            *replay_table_find(&grown, self->m_slots[i].m_id) = self->m_slots[i];
+        }
+    }
+
+    free(self->m_slots);
+    *self = grown;
+    return true;
+}
+
+/*!
+    \brief      Inserts (or replaces) the allocation for `id`.
+
+    \return     `true` on success, `false` if memory could not be allocated.
+ */
+static bool replay_table_insert(replay_table_t *self, uint64_t id, void *ptr, size_t size) {
+    if ((self->m_count + 1) * 2 > self->m_capacity && !replay_table_grow(self)) {
+        return false;
+    }
+
+    replay_slot_t *slot = replay_table_find(self, id);
+    self->m_count += slot->m_id == 0 ? 1 : 0;
+    *slot = (replay_slot_t){ id, ptr, size };
+    return true;
+}
+
+/*!
+    \brief      Removes `slot` from `self`, shifting back any entries
+                that probed past it.
+ */
+static void replay_table_erase(replay_table_t *self, replay_slot_t *slot) {
+    size_t mask = self->m_capacity - 1;
+    size_t hole = (size_t)(slot - self->m_slots);
+    size_t i = hole;
+
+    for (;;) {
+        i = (i + 1) & mask;
+
+        if (self->m_slots[i].m_id == 0) {
+            break;
+        }
+
+        size_t home = replay_hash(self->m_slots[i].m_id, self->m_capacity);
+
+        // Move the entry at `i` into the hole, unless its home lies within (hole, i].
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            self->m_slots[hole] = self->m_slots[i];
+            hole = i;
+        }
+    }
+
+    self->m_slots[hole].m_id = 0;
+    --self->m_count;
+}
+
+/*!
+    \brief      Program execution begins and ends here.
+
+    \param[in]  argc    Command line argument count
+    \param[in]  argv    Command line arguments
+
+    \return     0 on success, non-zero on failure
+ */
+int main(int argc, const char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <trace file>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *trace = fopen(argv[1], "rb");
+    cgcs_trace_header_t header;
+
+    if (!trace || fread(&header, sizeof header, 1, trace) != 1
+    || memcmp(header.m_magic, CGCS_TRACE_MAGIC, sizeof header.m_magic) != 0
+    || header.m_version != CGCS_TRACE_VERSION || header.m_record_size != sizeof(cgcs_trace_record_t)) {
+        fprintf(stderr, "%s: %s is not a version %d cgcs trace\n", argv[0], argv[1], CGCS_TRACE_VERSION);
+        return EXIT_FAILURE;
+    }
+
+    static cgcs_trace_record_t records[REPLAY_READ_RECORDS];
+    replay_table_t live = { NULL, 0, 0 };
+
+    struct {
+        size_t records;
+        size_t allocations;
+        size_t reallocations;
+        size_t frees;
+        size_t failures;
+        size_t unmatched;
+        uint64_t bytes;
+    } info = { 0, 0, 0, 0, 0, 0, 0 };
+
+    if (!replay_table_grow(&live)) {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    size_t count = 0;
+
+    while ((count = fread(records, sizeof *records, REPLAY_READ_RECORDS, trace)) > 0) {
+        for (size_t r = 0; r < count; ++r) {
+            const cgcs_trace_record_t *record = &records[r];
+            size_t size = record->m_size > 0 ? (size_t)(record->m_size) : 1;
+
+            ++info.records;
+
+            switch (record->m_op) {
+            case CGCS_TRACE_MALLOC:
+            case CGCS_TRACE_CALLOC:
+            case CGCS_TRACE_MEMALIGN: {
+                if (record->m_id == 0) {
+                    break;
+                }
+
+                void *ptr = cgcs_malloc(size);
+
+                ++info.allocations;
+                info.bytes += size;
+                info.failures += ptr ? 0 : 1;
+
+                replay_table_insert(&live, record->m_id, ptr, size);
+                break;
+            }
+            case CGCS_TRACE_REALLOC: {
+                replay_slot_t *old = record->m_old_id ? replay_table_find(&live, record->m_old_id) : NULL;
+                void *ptr = NULL;
+
+                ++info.reallocations;
+
+                if (record->m_id != 0) {
+                    ptr = cgcs_malloc(size);
+                    info.bytes += size;
+                    info.failures += ptr ? 0 : 1;
+                }
+
+                if (old && old->m_id != 0) {
+                    if (ptr && old->m_ptr) {
+                        memcpy(ptr, old->m_ptr, old->m_size < size ? old->m_size : size);
+                    }
+
+                    if (old->m_ptr) {
+                        cgcs_free(old->m_ptr);
+                    }
+
+                    replay_table_erase(&live, old);
+                } else if (record->m_old_id != 0) {
+                    ++info.unmatched;
+                }
+
+                if (record->m_id != 0) {
+                    replay_table_insert(&live, record->m_id, ptr, size);
+                }
+
+                break;
+            }
+            case CGCS_TRACE_FREE: {
+                replay_slot_t *slot = replay_table_find(&live, record->m_id);
+
+                ++info.frees;
+
+                if (slot->m_id == 0) {
+                    ++info.unmatched;
+                    break;
+                }
+
+                if (slot->m_ptr) {
+                    cgcs_free(slot->m_ptr);
+                }
+
+                replay_table_erase(&live, slot);
+                break;
+            }
+            default:
+                fprintf(stderr, "%s: unknown operation %u in record %lu\n",
+                        argv[0], record->m_op, (unsigned long)(info.records));
+                break;
+            }
+        }
+    }
+
+    struct timespec finish;
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+
+    uint64_t elapsed_ns = (uint64_t)(finish.tv_sec - start.tv_sec) * 1000000000ULL
+                        + (uint64_t)(finish.tv_nsec) - (uint64_t)(start.tv_nsec);
+
+    printf("cgcs_trace_replay: %s\n\n", argv[1]);
+    printf("Records:\t\t%lu\n", (unsigned long)(info.records));
+    printf("Allocations:\t\t%lu (%lu bytes)\n", (unsigned long)(info.allocations), (unsigned long)(info.bytes));
+    printf("Reallocations:\t\t%lu\n", (unsigned long)(info.reallocations));
+    printf("Frees:\t\t\t%lu\n", (unsigned long)(info.frees));
+    printf("Failed allocations:\t%lu\n", (unsigned long)(info.failures));
+    printf("Unmatched frees:\t%lu\n", (unsigned long)(info.unmatched));
+    printf("Live at end:\t\t%lu\n\n", (unsigned long)(live.m_count));
+    printf("Replay time:\t\t%lu ns (%.1f ns/record)\n",
+           (unsigned long)(elapsed_ns), info.records ? (double)(elapsed_ns) / (double)(info.records) : 0.0);
+
+    for (size_t i = 0; i < live.m_capacity; ++i) {
+        if (live.m_slots[i].m_id != 0 && live.m_slots[i].m_ptr) {
+            cgcs_free(live.m_slots[i].m_ptr);
+        }
+    }
+
+    free(live.m_slots);
+    fclose(trace);
+
+    return EXIT_SUCCESS;
+}